@@ -6,6 +6,42 @@
 #include <iomanip>
 #include <climits>
 #include <queue> // For Round Robin ready queue
+#include <fstream>
+#include <cstdlib>
+#include <cctype>
+#include <map>
+#include <unordered_map>
+#include <cmath>
+#include <sstream>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#include <filesystem>
 
 using namespace std;
 
@@ -19,145 +55,948 @@ public:
     int ct;         // Completion Time
     int tat;        // Turn Around Time
     int wt;         // Waiting Time
+    int rt;         // Response Time (first dispatch - AT), -1 until first dispatched
     int priority;   // Priority (Smaller number = Higher Priority)
+    int task;       // Rows sharing a task are successive CPU bursts of it; 0 for none
+    int predicted;  // Burst predicted on arrival by psjf / psrtf, 0 until then
     
     // Constructor
-    Process(int id, int a, int b, int p) {
+    Process(int id, int a, int b, int p, int t = 0) {
         pid = id;
         at = a;
         bt = b;
         rem_bt = b; // Initialize remaining time to original burst time
         priority = p;
+        task = t;
+        predicted = 0;
         ct = tat = wt = 0;
+        rt = -1;
+    }
+};
+
+// LEB128-style unsigned varint: 7 bits per byte, high bit set on all but the last
+void putVarint(string &out, unsigned long long v) {
+    while (v >= 0x80) {
+        out.push_back((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+bool getVarint(const char* &p, const char* end, unsigned long long &v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char b = *p++;
+        v |= (unsigned long long)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+string segmentLabel(int pid) {
+    return pid == 0 ? "IDLE" : "P" + to_string(pid);
+}
+
+// Cap on sealed Gantt chunks held in memory across all charts, in bytes
+// (0 = unlimited); set with --gantt-mem. Past it, charts spill to disk.
+size_t ganttMemoryCap = 0;
+atomic<size_t> ganttResidentBytes{0};
+// Set when a spilled chunk cannot be read back; commands then exit non-zero
+// even where a consumer could only stop early
+atomic<bool> ganttReadFailed{false};
+
+// Append-only scratch file for spilled Gantt chunks. It is unlinked as soon as
+// it is created, so it disappears with the process; copies of a chart share it.
+class SpillFile {
+public:
+    SpillFile() {
+        const char* dir = getenv("TMPDIR");
+        string path = string(dir && *dir ? dir : "/tmp") + "/gantt-XXXXXX";
+        fd = mkstemp(&path[0]);
+        if (fd >= 0) unlink(path.c_str());
+        else cerr << "Warning: cannot create Gantt spill file: " << strerror(errno)
+                  << "; keeping the chart in memory\n";
+    }
+    ~SpillFile() { if (fd >= 0) ::close(fd); }
+
+    bool ok() const { return fd >= 0; }
+
+    // Appends data and returns its offset, or -1 on failure
+    long long append(const string &data) {
+        lock_guard<mutex> lock(m);
+        for (size_t done = 0; done < data.size(); ) {
+            ssize_t n = pwrite(fd, data.data() + done, data.size() - done, size + done);
+            if (n <= 0) return -1;
+            done += n;
+        }
+        size += data.size();
+        return size - data.size();
+    }
+
+    bool read(long long offset, size_t length, string &out) const {
+        out.resize(length);
+        for (size_t done = 0; done < length; ) {
+            ssize_t n = pread(fd, &out[done], length - done, offset + done);
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+private:
+    int fd;
+    long long size = 0;
+    mutex m;
+};
+
+// Gantt chart stored compactly: each segment is a varint duration followed by
+// a varint pid (0 for IDLE), a few bytes instead of an int plus a string.
+// Segments are packed into chunks of CHUNK; a sparse index keeps each chunk's
+// start time, so a lookup decodes at most one chunk.
+//
+// Blocks are appended with push(start, pid), which extends the open block
+// when pid is unchanged, and the chart is closed with finish(end). Only
+// closed segments are visible to cursors.
+//
+// Chunks are sealed as they fill. While the sealed chunks of all charts take
+// more than ganttMemoryCap, a chart that seals one writes its sealed chunks to
+// a SpillFile; cursors read them back one chunk at a time, so memory stays at
+// the cap plus one open chunk and the index per chart.
+class GanttChart {
+public:
+    struct Segment {
+        int start, end, pid;
+    };
+
+    class Cursor {
+    public:
+        // Decodes the next segment; false past the last one or once a spilled
+        // chunk could not be read, which failed() tells apart
+        bool next(Segment &seg) {
+            if (readFailed || index >= chart->count) return false;
+            if (index % CHUNK == 0) {
+                chunk = index / CHUNK;
+                pos = 0;
+                time = chart->chunkStart[chunk];
+                if (chunk < chart->spilled.size() && !chart->readSpilled(chunk, buf)) {
+                    readFailed = true;
+                    return false;
+                }
+            }
+            const string &data = chunk < chart->spilled.size() ? buf : chart->resident[chunk - chart->spilled.size()];
+            const char* p = data.data() + pos;
+            const char* end = data.data() + data.size();
+            unsigned long long duration = 0, pid = 0;
+            getVarint(p, end, duration);
+            getVarint(p, end, pid);
+            pos = p - data.data();
+            seg = {time, time + (int)duration, (int)pid};
+            time = seg.end;
+            index++;
+            return true;
+        }
+
+        bool failed() const { return readFailed; }
+
+    private:
+        friend class GanttChart;
+        const GanttChart* chart;
+        size_t index, chunk = 0, pos = 0;
+        string buf;   // Current chunk when it was spilled
+        int time = 0;
+        bool readFailed = false;
+    };
+
+    GanttChart() {}
+    GanttChart(const GanttChart& o) { *this = o; }
+    GanttChart& operator=(const GanttChart& o) {
+        if (this == &o) return *this;
+        release();
+        resident = o.resident;
+        spilled = o.spilled;
+        spill = o.spill;
+        chunkStart = o.chunkStart;
+        count = o.count;
+        lastEnd = o.lastEnd;
+        openStart = o.openStart;
+        openPid = o.openPid;
+        sealedBytes = o.sealedBytes;
+        spilledBytes = o.spilledBytes;
+        recording = o.recording;
+        ganttResidentBytes += sealedBytes;
+        return *this;
+    }
+
+    // Moving leaves the source as an empty chart
+    GanttChart(GanttChart&& o) noexcept { *this = move(o); }
+    GanttChart& operator=(GanttChart&& o) noexcept {
+        if (this == &o) return *this;
+        release();
+        resident = move(o.resident);
+        spilled = move(o.spilled);
+        spill = move(o.spill);
+        chunkStart = move(o.chunkStart);
+        o.resident.clear();
+        o.spilled.clear();
+        o.chunkStart.clear();
+        count = exchange(o.count, 0);
+        lastEnd = exchange(o.lastEnd, 0);
+        openStart = exchange(o.openStart, 0);
+        openPid = exchange(o.openPid, -1);
+        sealedBytes = exchange(o.sealedBytes, 0);
+        spilledBytes = exchange(o.spilledBytes, 0);
+        recording = exchange(o.recording, true);
+        return *this;
+    }
+
+    ~GanttChart() { ganttResidentBytes -= sealedBytes; }
+
+    // Metrics-only runs: later blocks are dropped and the chart stays empty
+    void disable() { recording = false; }
+
+    void push(int start, int pid) {
+        if (!recording || openPid == pid) return;
+        if (openPid >= 0 && start > openStart) append(openStart, start, openPid);
+        openStart = start;
+        openPid = pid;
+    }
+
+    void finish(int end) {
+        if (openPid >= 0 && end > openStart) append(openStart, end, openPid);
+        openPid = -1;
+    }
+
+    // Block still being extended, if any
+    bool openBlock(int &start, int &pid) const {
+        start = openStart;
+        pid = openPid;
+        return openPid >= 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    int endTime() const { return lastEnd; }
+    // Memory held by the chart; spilled chunks only count towards the index
+    size_t bytes() const {
+        size_t total = chunkStart.capacity() * sizeof(int) + spilled.capacity() * sizeof(SpillRef) +
+                       resident.size() * sizeof(string);
+        for (const auto &c : resident) total += c.capacity();
+        return total;
+    }
+    size_t diskBytes() const { return spilledBytes; }
+
+    // Cursor at segment i (i == size() gives an exhausted cursor)
+    Cursor at(size_t i) const {
+        Cursor c;
+        c.chart = this;
+        c.index = i - i % CHUNK;
+        Segment skip;
+        while (c.index < i && c.next(skip)) {}
+        return c;
+    }
+
+    // Cursor at the segment containing t, or the first one after t
+    Cursor seek(int t) const {
+        size_t chunk = upper_bound(chunkStart.begin(), chunkStart.end(), t) - chunkStart.begin();
+        Cursor c = at(chunk > 0 ? (chunk - 1) * CHUNK : 0);
+        size_t i = c.index;
+        Segment seg;
+        while (c.next(seg) && seg.end <= t) i = c.index;
+        return at(i);
+    }
+
+    // Segment running at time t; false if t is outside the chart
+    bool find(int t, Segment &seg) const {
+        Cursor c = seek(t);
+        return c.next(seg) && seg.start <= t && t < seg.end;
+    }
+
+private:
+    struct SpillRef {
+        long long offset;
+        size_t length;
+    };
+
+    static const size_t CHUNK = 256;
+    deque<string> resident;      // Chunks still in memory, after the spilled ones
+    vector<SpillRef> spilled;    // Where each spilled chunk lives in the file
+    shared_ptr<SpillFile> spill;
+    vector<int> chunkStart;
+    size_t count = 0;
+    int lastEnd = 0;
+    int openStart = 0, openPid = -1;
+    size_t sealedBytes = 0;      // Sealed resident chunks, as counted in ganttResidentBytes
+    size_t spilledBytes = 0;
+    bool recording = true;
+
+    void release() {
+        ganttResidentBytes -= sealedBytes;
+        sealedBytes = 0;
+    }
+
+    void append(int start, int end, int pid) {
+        if (count % CHUNK == 0) {
+            if (!resident.empty()) seal();
+            resident.emplace_back();
+            resident.back().reserve(CHUNK * 3);
+            chunkStart.push_back(start);
+        }
+        putVarint(resident.back(), end - start);
+        putVarint(resident.back(), pid);
+        count++;
+        lastEnd = end;
+    }
+
+    void seal() {
+        resident.back().shrink_to_fit();
+        sealedBytes += resident.back().capacity();
+        ganttResidentBytes += resident.back().capacity();
+        if (ganttMemoryCap > 0 && ganttResidentBytes > ganttMemoryCap) spillSealed();
+    }
+
+    // Called right after sealing, so every resident chunk is sealed: moves
+    // them all to the spill file in one write. On failure they stay in memory
+    void spillSealed() {
+        if (!spill) spill = make_shared<SpillFile>();
+        if (!spill->ok()) return;
+        string batch;
+        for (size_t i = 0; i < resident.size(); i++) batch += resident[i];
+        long long offset = spill->append(batch);
+        if (offset < 0) return;
+        for (const auto &c : resident) {
+            spilled.push_back({offset, c.size()});
+            offset += c.size();
+            spilledBytes += c.size();
+        }
+        resident.clear();
+        release();
+    }
+
+    bool readSpilled(size_t chunk, string &out) const {
+        if (spill->read(spilled[chunk].offset, spilled[chunk].length, out)) return true;
+        cerr << "Error: cannot read Gantt spill file: " << strerror(errno) << "\n";
+        ganttReadFailed = true;
+        return false;
+    }
+};
+
+// Finished run of one algorithm: final process metrics plus its Gantt chart
+struct Schedule {
+    string algorithmName;
+    vector<Process> procs;
+    GanttChart gantt;
+};
+
+// Receives scheduling events from an engine as they happen, in time order.
+// Arrivals are not reported separately: observers that need them take the
+// arrival times from onStart() and merge them with the event stream.
+class SimObserver {
+public:
+    virtual ~SimObserver() {}
+    virtual void onStart(const vector<Process>&) {}
+    virtual void onDispatch(int, const Process&) {}   // the process gets the CPU
+    virtual void onPreempt(int, const Process&) {}    // the process leaves the CPU unfinished
+    virtual void onComplete(int, const Process&) {}
+    virtual void onFinish(int) {}
+};
+
+// Nearest-rank percentile (q in [0, 1]); reorders v
+int percentile(vector<int>& v, double q) {
+    if (v.empty()) return 0;
+    size_t rank = (size_t)ceil(q * v.size());   // smallest rank covering q of the values
+    size_t k = rank ? min(rank, v.size()) - 1 : 0;
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// Running WT/TAT/RT totals for one group of processes
+struct MetricAccumulator {
+    long long count = 0;
+    double sumWT = 0, sumTAT = 0, sumRT = 0;
+    int maxWT = 0;
+
+    void add(const Process& p) {
+        count++;
+        sumWT += p.wt;
+        sumTAT += p.tat;
+        sumRT += p.rt;
+        maxWT = max(maxWT, p.wt);
     }
 };
 
+// Burst-size bucket: 0 for BT 1, 1 for BT 2-3, 2 for BT 4-7, ...
+int burstBucket(int bt) {
+    return 31 - __builtin_clz((unsigned)bt);
+}
+
+void printBreakdownRow(ostream& out, const string& label, const MetricAccumulator& m) {
+    out << label << "\t" << m.count << "\t" << m.sumWT / m.count << "\t"
+        << m.sumTAT / m.count << "\t" << m.sumRT / m.count << "\t" << m.maxWT << "\n";
+}
+
 // Helper function to print results in a structured table
-void printResults(vector<Process> &procs, const vector<int>& timeline, const vector<string>& blocks, const string& algorithmName) {
+void printResults(vector<Process> &procs, const GanttChart& gantt, const string& algorithmName, ostream& out = cout) {
     int fixedWidth = 8;
     int idleTime = 0;
-    float totalTAT = 0, totalWT = 0;
+    float totalTAT = 0, totalWT = 0, totalRT = 0;
     int n = procs.size();
+    vector<int> responseTimes;
+    responseTimes.reserve(n);
+    map<int, MetricAccumulator> byPriority;
+    MetricAccumulator byBurst[32];
 
     // Re-sort processes by PID for a clean result table display
     sort(procs.begin(), procs.end(), [](Process &a, Process &b){
         return a.pid < b.pid;
     });
 
-    cout << "\n---------------------------------------------------------------\n";
-    cout << "\t\t" << algorithmName << " Results\n";
-    cout << "---------------------------------------------------------------\n";
+    out << "\n---------------------------------------------------------------\n";
+    out << "\t\t" << algorithmName << " Results\n";
+    out << "---------------------------------------------------------------\n";
 
-    cout << "\nGantt Chart (" << algorithmName << "):\n";
+    out << "\nGantt Chart (" << algorithmName << "):\n";
     
     // ---- print blocks ----
-    for (const auto &b : blocks) {
-        cout << "| " << left << setw(fixedWidth - 2) << b;
+    // Both rows stream from the chart, which may be spilled to disk
+    GanttChart::Segment seg;
+    for (GanttChart::Cursor c = gantt.at(0); c.next(seg); ) {
+        out << "| " << left << setw(fixedWidth - 2) << segmentLabel(seg.pid);
     }
-    cout << "|\n";
+    out << "|\n";
     
     // ---- print timeline ----
-    for (size_t i = 0; i < timeline.size(); i++) {
-        cout << left << setw(fixedWidth) << timeline[i];
+    for (GanttChart::Cursor c = gantt.at(0); c.next(seg); ) {
+        out << left << setw(fixedWidth) << seg.start;
     }
-    cout << "\n\n";
+    if (!gantt.empty()) out << left << setw(fixedWidth) << gantt.endTime();
+    out << "\n\n";
 
     // Print table header based on algorithm
     if (algorithmName.find("Priority") != string::npos) {
-        cout << "PID\tAT\tBT\tPRI\tCT\tTAT\tWT\n";
-        cout << "-------------------------------------------------------------\n";
+        out << "PID\tAT\tBT\tPRI\tCT\tTAT\tWT\tRT\n";
+        out << "---------------------------------------------------------------------\n";
     } else {
-        cout << "PID\tAT\tBT\tCT\tTAT\tWT\n";
-        cout << "------------------------------------------------\n";
+        out << "PID\tAT\tBT\tCT\tTAT\tWT\tRT\n";
+        out << "--------------------------------------------------------\n";
     }
 
     // Print process metrics and calculate totals
     for (auto &p : procs) {
         totalTAT += p.tat;
         totalWT += p.wt;
-        cout << p.pid << "\t" << p.at << "\t" << p.bt;
+        totalRT += p.rt;
+        responseTimes.push_back(p.rt);
+        byPriority[p.priority].add(p);
+        byBurst[burstBucket(p.bt)].add(p);
+        out << p.pid << "\t" << p.at << "\t" << p.bt;
         if (algorithmName.find("Priority") != string::npos) {
-            cout << "\t" << p.priority;
+            out << "\t" << p.priority;
         }
-        cout << "\t" << p.ct << "\t" << p.tat << "\t" << p.wt << "\n";
+        out << "\t" << p.ct << "\t" << p.tat << "\t" << p.wt << "\t" << p.rt << "\n";
     }
 
     // Idle time calculation
-    for (size_t i = 0; i < blocks.size(); i++) {
-        if (blocks[i] == "IDLE" && i + 1 < timeline.size()) {
-            idleTime += timeline[i+1] - timeline[i];
-        }
+    for (GanttChart::Cursor c = gantt.at(0); c.next(seg); ) {
+        if (seg.pid == 0) idleTime += seg.end - seg.start;
     }
     
-    cout << fixed << setprecision(2);
-    cout << "\nAverage Turn Around Time: " << totalTAT / n << " units\n";
-    cout << "Average Waiting Time: " << totalWT / n << " units\n";
-    cout << "Total CPU Idle Time: " << idleTime << " units\n";
+    out << fixed << setprecision(2);
+    out << "\nAverage Turn Around Time: " << totalTAT / n << " units\n";
+    out << "Average Waiting Time: " << totalWT / n << " units\n";
+    out << "Average Response Time: " << totalRT / n << " units\n";
+    out << "Response Time p50/p90/p99: " << percentile(responseTimes, 0.50) << " / "
+        << percentile(responseTimes, 0.90) << " / " << percentile(responseTimes, 0.99) << " units\n";
+    out << "Total CPU Idle Time: " << idleTime << " units\n";
+
+    // ---- per-class breakdown ----
+    out << "\nBy Priority:\n";
+    out << "PRI\tCOUNT\tAvgWT\tAvgTAT\tAvgRT\tMaxWT\n";
+    for (const auto &entry : byPriority) {
+        printBreakdownRow(out, to_string(entry.first), entry.second);
+    }
+
+    out << "\nBy Burst Size:\n";
+    out << "BT\tCOUNT\tAvgWT\tAvgTAT\tAvgRT\tMaxWT\n";
+    for (int b = 0; b < 32; b++) {
+        if (byBurst[b].count == 0) continue;
+        long long lo = 1LL << b, hi = (1LL << (b + 1)) - 1;
+        printBreakdownRow(out, lo == hi ? to_string(lo) : to_string(lo) + "-" + to_string(hi), byBurst[b]);
+    }
+}
+
+void printResults(Schedule &s, ostream& out = cout) {
+    printResults(s.procs, s.gantt, s.algorithmName, out);
 }
 
 // -----------------------------------------------------------------------------
-// FCFS Scheduling
+// Fairness Metrics
 // -----------------------------------------------------------------------------
 
-void FCFS(vector<Process> procs) {
-    // FCFS rule: Sort by Arrival Time (AT)
-    sort(procs.begin(), procs.end(), [](Process &a, Process &b){
-        return a.at < b.at;
-    });
+// Slowdown (TAT / BT) statistics folded in as each process completes. Nothing
+// is kept per process: percentiles come from a log-scale histogram whose bins
+// are 2% wide, and Jain's index only needs the sum and sum of squares.
+class FairnessTracker : public SimObserver {
+public:
+    static const int BINS = 1024;
+
+    void onStart(const vector<Process>&) override {
+        *this = FairnessTracker();
+    }
+
+    void onComplete(int, const Process& p) override {
+        double slowdown = (double)p.tat / p.bt;
+        count++;
+        sum += slowdown;
+        sumSq += slowdown * slowdown;
+        minSlowdown = count == 1 ? slowdown : min(minSlowdown, slowdown);
+        maxSlowdown = max(maxSlowdown, slowdown);
+        int bin = (int)(log(slowdown) / log(GROWTH));
+        hist[min(max(bin, 0), BINS - 1)]++;
+        if (p.wt > maxStarvation) {
+            maxStarvation = p.wt;
+            starvedPid = p.pid;
+        }
+    }
 
+    // Jain's fairness index over slowdowns: 1 when every job is slowed equally
+    double jainIndex() const {
+        return sumSq > 0 ? sum * sum / (count * sumSq) : 1.0;
+    }
+
+    // Bounds of the histogram bin holding the nearest-rank slowdown percentile
+    // (q in [0, 1]), narrowed to the observed minimum and maximum
+    pair<double, double> slowdownPercentile(double q) const {
+        long long target = max(1LL, (long long)ceil(q * count)), seen = 0;
+        for (int b = 0; b < BINS - 1; b++) {
+            seen += hist[b];
+            if (seen >= target)
+                return {max(pow(GROWTH, b), minSlowdown), min(pow(GROWTH, b + 1), maxSlowdown)};
+        }
+        return {max(pow(GROWTH, BINS - 1), minSlowdown), maxSlowdown};
+    }
+
+    void print(ostream& out = cout) const {
+        if (count == 0) return;
+        out << "\nFairness:\n";
+        out << "Average Slowdown (TAT/BT): " << sum / count << "\n";
+        out << "Slowdown p50/p90/p99/max: ";
+        for (double q : {0.50, 0.90, 0.99}) {
+            pair<double, double> b = slowdownPercentile(q);
+            out << b.first;
+            if (b.second - b.first >= 0.005) out << "-" << b.second;  // Bin spans several printed values
+            out << " / ";
+        }
+        out << maxSlowdown << "\n";
+        out << "Jain's Fairness Index (slowdown): " << setprecision(4) << jainIndex()
+            << setprecision(2) << "\n";
+        out << "Max Starvation Time: " << maxStarvation << " units (P" << starvedPid << ")\n";
+    }
+
+private:
+    static constexpr double GROWTH = 1.02;
+    long long count = 0;
+    double sum = 0, sumSq = 0, minSlowdown = 0, maxSlowdown = 0;
+    int maxStarvation = 0;  // Longest total time any process spent ready but not running
+    int starvedPid = 0;
+    long long hist[BINS] = {};
+};
+
+// -----------------------------------------------------------------------------
+// Engine State and Checkpoints
+// -----------------------------------------------------------------------------
+
+// Complete state of an engine mid-run. The engines keep their loop variables
+// here rather than in locals, so a run can be saved and continued later.
+struct SimState {
+    string algo;              // fcfs, sjf, priority, srtf, rr, asjf, psjf or psrtf
+    int quantum = 0;          // RR quantum; asjf buckets per octave
+    string predictor;         // psjf / psrtf: burst predictor spec
+    bool started = false;     // Initial sorting / resets already done
     int time = 0;
-    vector<int> timeline;
-    vector<string> blocks;
+    int completedCount = 0;
+    int nextArrival = 0;      // FCFS: next process to run; RR: next to arrive
+    int lastIdx = -1;         // SRTF: unfinished process that ran last
+    string lastBlock;         // SRTF / RR: block the previous step extended
+    int pauseAt = INT_MAX;    // Engines return early at the first decision point >= pauseAt
+    vector<Process> procs;
+    vector<char> completed;   // SJF / Priority
+    vector<char> inQueue;     // RR
+    deque<int> readyQueue;    // RR
+    GanttChart gantt;
 
-    timeline.push_back(0);
+    SimState() {}
+    SimState(const string& a, vector<Process> p, int q = 0) : algo(a), quantum(q), procs(move(p)) {}
 
-    for (auto &p : procs) {
+    // Prepares for a new run of `a` with no processes yet; the vectors keep
+    // their capacity, so a reused state stops allocating once it has grown
+    void reset(const string& a, int q = 0) {
+        algo = a;
+        quantum = q;
+        predictor.clear();
+        started = false;
+        time = completedCount = nextArrival = 0;
+        lastIdx = -1;
+        lastBlock.clear();
+        pauseAt = INT_MAX;
+        procs.clear();
+        completed.clear();
+        inQueue.clear();
+        readyQueue.clear();
+        gantt = GanttChart();
+    }
+};
+
+// Tells an observer that a run starts. For a resumed run the completions
+// before the checkpoint are replayed so completion-based metrics stay whole.
+void notifyStart(const SimState &st, SimObserver* obs) {
+    if (!obs) return;
+    obs->onStart(st.procs);
+    vector<const Process*> done;
+    for (const auto &p : st.procs) {
+        if (p.ct > 0) done.push_back(&p);
+    }
+    sort(done.begin(), done.end(), [](const Process* a, const Process* b){
+        return a->ct < b->ct;
+    });
+    for (const Process* p : done) obs->onComplete(p->ct, *p);
+}
+
+// Set from SIGINT/SIGTERM; the next poll writes a checkpoint and exits
+volatile sig_atomic_t stopRequested = 0;
+
+// Writes periodic binary checkpoints of a SimState. Closed Gantt segments
+// only ever grow, so they go to an append-only "<path>.gantt" file and each
+// checkpoint writes just the segments closed since the previous one; the
+// checkpoint itself records how many are valid plus the still-open block.
+// The state file is replaced via rename so a crash mid-write keeps the
+// previous checkpoint.
+class Checkpointer {
+public:
+    Checkpointer(const string& p, double intervalSec, size_t committed = 0)
+        : path(p), interval(intervalSec), committedSegments(committed),
+          last(chrono::steady_clock::now()) {}
+
+    // Called once per engine step; cheap unless a checkpoint is due
+    void poll(const SimState &st) {
+        if (stopRequested) {
+            bool ok = save(st);
+            cout.flush();
+            fprintf(stderr, ok ? "\nInterrupted: checkpoint written to %s\n"
+                               : "\nInterrupted: could not write checkpoint %s\n", path.c_str());
+            _exit(130);
+        }
+        if (++steps % 4096 != 0) return;
+        auto now = chrono::steady_clock::now();
+        if (chrono::duration<double>(now - last).count() < interval) return;
+        save(st);
+        last = now;
+    }
+
+    bool save(const SimState &st) {
+        // 1. Append newly closed segments as (start, pid) pairs
+        int fd = ::open((path + ".gantt").c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) return false;
+        vector<int> rec;
+        rec.reserve((st.gantt.size() - committedSegments) * 2);
+        GanttChart::Cursor c = st.gantt.at(committedSegments);
+        GanttChart::Segment seg;
+        while (c.next(seg)) {
+            rec.push_back(seg.start);
+            rec.push_back(seg.pid);
+        }
+        if (c.failed()) {
+            ::close(fd);
+            return false;
+        }
+        size_t bytes = rec.size() * sizeof(int);
+        bool ok = pwrite(fd, rec.data(), bytes, committedSegments * 2 * sizeof(int)) == (ssize_t)bytes;
+        ok = ok && fdatasync(fd) == 0;
+        ::close(fd);
+        if (!ok) return false;
+
+        // 2. Write the state and atomically replace the previous checkpoint
+        string tmp = path + ".tmp";
+        {
+            ofstream out(tmp, ios::binary | ios::trunc);
+            out.write("SIMCKPT3", 8);
+            putString(out, st.algo);
+            putString(out, st.predictor);
+            putInts(out, {st.quantum, st.started, st.time, st.completedCount, st.nextArrival, st.lastIdx});
+            putString(out, st.lastBlock);
+            putCount(out, st.procs.size());
+            for (const auto &p : st.procs) {
+                putInts(out, {p.pid, p.at, p.bt, p.rem_bt, p.ct, p.tat, p.wt, p.rt, p.priority, p.task, p.predicted});
+            }
+            putCount(out, st.completed.size());
+            out.write(st.completed.data(), st.completed.size());
+            putCount(out, st.inQueue.size());
+            out.write(st.inQueue.data(), st.inQueue.size());
+            putCount(out, st.readyQueue.size());
+            for (int idx : st.readyQueue) putInts(out, {idx});
+            int openStart, openPid;
+            st.gantt.openBlock(openStart, openPid);
+            putCount(out, st.gantt.size());
+            putInts(out, {openStart, openPid});
+            if (!out.flush()) return false;
+        }
+        if (rename(tmp.c_str(), path.c_str()) != 0) return false;
+        committedSegments = st.gantt.size();
+        saved++;
+        return true;
+    }
+
+    long long saved = 0;
+
+private:
+    string path;
+    double interval;
+    size_t committedSegments;
+    long long steps = 0;
+    chrono::steady_clock::time_point last;
+
+    static void putCount(ostream& out, unsigned long long v) {
+        out.write((const char*)&v, sizeof(v));
+    }
+    static void putInts(ostream& out, initializer_list<int> vals) {
+        for (int v : vals) out.write((const char*)&v, sizeof(v));
+    }
+    static void putString(ostream& out, const string& v) {
+        putCount(out, v.size());
+        out.write(v.data(), v.size());
+    }
+};
+
+// Reads a checkpoint written by Checkpointer::save back into st; `segments`
+// receives the number of Gantt blocks restored from the .gantt file
+// Defined with the command-line parsing below
+bool parseAlgorithm(const string& spec, string &algo, int &quantum);
+
+// Every index a resumed engine will follow must land inside the process
+// table, and the per-process flag arrays must cover it
+bool checkpointConsistent(const SimState &st) {
+    long long n = st.procs.size();
+    for (const auto &p : st.procs) {
+        if (p.pid < 1 || p.pid > n) return false;
+    }
+    for (int i : st.readyQueue) {
+        if (i < 0 || i >= n) return false;
+    }
+    bool flagsNeeded = st.started && (st.algo == "sjf" || st.algo == "priority");
+    bool queueNeeded = st.started && st.algo == "rr";
+    return (st.lastIdx == -1 || (st.lastIdx >= 0 && st.lastIdx < n)) &&
+           st.nextArrival >= 0 && st.nextArrival <= n &&
+           st.completedCount >= 0 && st.completedCount <= n &&
+           (st.completed.size() == (size_t)n || (st.completed.empty() && !flagsNeeded)) &&
+           (st.inQueue.size() == (size_t)n || (st.inQueue.empty() && !queueNeeded));
+}
+
+bool loadCheckpoint(const string& path, SimState &st, size_t &segments, string &error) {
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in) {
+        error = "cannot open file";
+        return false;
+    }
+    long long fileSize = in.tellg();
+    in.seekg(0);
+    char magic[8];
+    if (!in.read(magic, 8) || memcmp(magic, "SIMCKPT3", 8) != 0) {
+        bool old = in && memcmp(magic, "SIMCKPT", 7) == 0 && magic[7] < '3';
+        error = old ? "checkpoint format too old" : "not a checkpoint file";
+        return false;
+    }
+
+    auto count = [&]() {
+        unsigned long long v = 0;
+        in.read((char*)&v, sizeof(v));
+        return v;
+    };
+    // A count of items of `size` bytes; one the rest of the file cannot hold
+    // marks the checkpoint corrupt, so nothing is allocated for it
+    auto bounded = [&](size_t size) {
+        unsigned long long v = count();
+        long long left = in ? fileSize - (long long)in.tellg() : 0;
+        if (v > (unsigned long long)max(left, 0LL) / size) {
+            in.setstate(ios::failbit);
+            return 0ULL;
+        }
+        return v;
+    };
+    auto integer = [&]() {
+        int v = 0;
+        in.read((char*)&v, sizeof(v));
+        return v;
+    };
+    auto str = [&]() {
+        string v(bounded(1), '\0');
+        in.read(&v[0], v.size());
+        return v;
+    };
+
+    st = SimState();
+    st.algo = str();
+    st.predictor = str();
+    st.quantum = integer();
+    st.started = integer();
+    st.time = integer();
+    st.completedCount = integer();
+    st.nextArrival = integer();
+    st.lastIdx = integer();
+    st.lastBlock = str();
+    size_t n = bounded(11 * sizeof(int));
+    if (!in) {
+        error = "truncated or corrupt checkpoint";
+        return false;
+    }
+    st.procs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        int f[11];
+        for (int &v : f) v = integer();
+        Process p(f[0], f[1], f[2], f[8], f[9]);
+        p.predicted = f[10];
+        p.rem_bt = f[3];
+        p.ct = f[4];
+        p.tat = f[5];
+        p.wt = f[6];
+        p.rt = f[7];
+        st.procs.push_back(p);
+    }
+    st.completed.resize(bounded(1));
+    in.read(st.completed.data(), st.completed.size());
+    st.inQueue.resize(bounded(1));
+    in.read(st.inQueue.data(), st.inQueue.size());
+    for (size_t i = bounded(sizeof(int)); i > 0; i--) st.readyQueue.push_back(integer());
+    segments = count();
+    int openStart = integer(), openPid = integer();
+    if (!in) {
+        error = "truncated or corrupt checkpoint";
+        return false;
+    }
+    string spec = st.algo == "rr" || st.algo == "asjf" ? st.algo + ":" + to_string(st.quantum) : st.algo;
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum) || algo != st.algo || quantum != st.quantum) {
+        error = "unknown algorithm in checkpoint";
+        return false;
+    }
+    if (!checkpointConsistent(st)) {
+        error = "inconsistent checkpoint state";
+        return false;
+    }
+
+    ifstream gantt(path + ".gantt", ios::binary | ios::ate);
+    if (!gantt || segments > (unsigned long long)max((long long)gantt.tellg(), 0LL) / (2 * sizeof(int))) {
+        error = "missing or truncated " + path + ".gantt";
+        return false;
+    }
+    gantt.seekg(0);
+    vector<int> rec(segments * 2);
+    if (!gantt.read((char*)rec.data(), rec.size() * sizeof(int))) {
+        error = "cannot read " + path + ".gantt";
+        return false;
+    }
+    for (size_t i = 0; i < segments; i++) st.gantt.push(rec[2 * i], rec[2 * i + 1]);
+    // The open block closes the last saved one
+    if (openPid >= 0) st.gantt.push(openStart, openPid);
+    else st.gantt.finish(st.time);
+    if (st.gantt.size() != segments) {
+        error = "Gantt segments do not match the checkpoint";
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// FCFS Scheduling
+// -----------------------------------------------------------------------------
+
+Schedule simulateFCFS(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
+    int n = procs.size();
+    if (!st.started) {
+        // FCFS rule: Sort by Arrival Time (AT), ties in input order
+        stable_sort(procs.begin(), procs.end(), [](const Process &a, const Process &b){
+            return a.at < b.at;
+        });
+        st.started = true;
+    }
+    notifyStart(st, obs);
+
+    int &time = st.time;
+    GanttChart &gantt = st.gantt;
+
+    for (; st.nextArrival < n && time < st.pauseAt; st.nextArrival++) {
+        if (ckpt) ckpt->poll(st);
+        Process &p = procs[st.nextArrival];
+        if (p.rem_bt == 0) continue; // Finished before a what-if fork
         if (p.at > time) {
             // CPU is IDLE until the process arrives
-            blocks.push_back("IDLE");
+            gantt.push(time, 0);
             time = p.at; // Advance time to process arrival
-            timeline.push_back(time);
         }
 
         // Execute the process
-        blocks.push_back("P" + to_string(p.pid));
-        time += p.bt;
-        timeline.push_back(time);
+        if (obs) obs->onDispatch(time, p);
+        if (p.rt < 0) p.rt = time - p.at;
+        gantt.push(time, p.pid);
+        time += p.rem_bt;
+        p.rem_bt = 0;
 
         // Calculate metrics
         p.ct = time;
         p.tat = p.ct - p.at;
         p.wt = p.tat - p.bt;
+        if (obs) obs->onComplete(time, p);
     }
+    if (st.nextArrival < n) return {}; // Paused
+    gantt.finish(time);
+    if (obs) obs->onFinish(time);
     
-    printResults(procs, timeline, blocks, "FCFS");
+    return {"FCFS", procs, move(gantt)};
+}
+
+Schedule runFCFS(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("fcfs", move(procs));
+    return simulateFCFS(st, obs);
+}
+
+void FCFS(vector<Process> procs) {
+    FairnessTracker fairness;
+    Schedule s = runFCFS(procs, &fairness);
+    printResults(s);
+    fairness.print();
 }
 
 // -----------------------------------------------------------------------------
 // SJF Non-Preemptive Scheduling
 // -----------------------------------------------------------------------------
 
-void SJF(vector<Process> procs) {
+Schedule simulateSJF(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
     int n = procs.size();
-    vector<bool> completed(n, false);
-    int time = 0, completedCount = 0;
-    vector<int> timeline;
-    vector<string> blocks;
-    timeline.push_back(0);
+    if (!st.started) {
+        st.completed.assign(n, false);
+        st.started = true;
+    }
+    notifyStart(st, obs);
+
+    vector<char> &completed = st.completed;
+    int &time = st.time, &completedCount = st.completedCount;
+    GanttChart &gantt = st.gantt;
 
-    while (completedCount < n) {
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
         int idx = -1;
         int minBT = INT_MAX;
 
         // 1. Find the process with minimum BT that has arrived (at <= time) and is not completed
         for (int i = 0; i < n; i++) {
             if (!completed[i] && procs[i].at <= time) {
-                if (procs[i].bt < minBT) {
-                    minBT = procs[i].bt;
+                if (procs[i].rem_bt < minBT) {
+                    minBT = procs[i].rem_bt;
                     idx = i;
                 }
                 // Tie-breaker: FCFS for equal burst times
-                else if (procs[i].bt == minBT) {
+                else if (procs[i].rem_bt == minBT) {
                     if (idx != -1 && procs[i].at < procs[idx].at) {
                         idx = i;
                     }
@@ -175,9 +1014,8 @@ void SJF(vector<Process> procs) {
             }
 
             if (next_arrival_time != INT_MAX) {
-                blocks.push_back("IDLE");
+                gantt.push(time, 0);
                 time = next_arrival_time; // Jump time directly
-                timeline.push_back(time);
             } else {
                 break;
             }
@@ -185,9 +1023,11 @@ void SJF(vector<Process> procs) {
             // 3. Execute the shortest job (non-preemptive)
             
             // Execute the process
-            blocks.push_back("P" + to_string(procs[idx].pid));
-            time += procs[idx].bt;
-            timeline.push_back(time);
+            if (obs) obs->onDispatch(time, procs[idx]);
+            if (procs[idx].rt < 0) procs[idx].rt = time - procs[idx].at;
+            gantt.push(time, procs[idx].pid);
+            time += procs[idx].rem_bt;
+            procs[idx].rem_bt = 0;
 
             // Calculate metrics and mark as completed
             procs[idx].ct = time;
@@ -195,25 +1035,164 @@ void SJF(vector<Process> procs) {
             procs[idx].wt = procs[idx].tat - procs[idx].bt;
             completed[idx] = true;
             completedCount++;
+            if (obs) obs->onComplete(time, procs[idx]);
+        }
+    }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time);
+    if (obs) obs->onFinish(time);
+
+    return {"SJF - Non Preemptive", procs, move(gantt)};
+}
+
+Schedule runSJF(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("sjf", move(procs));
+    return simulateSJF(st, obs);
+}
+
+void SJF(vector<Process> procs) {
+    FairnessTracker fairness;
+    Schedule s = runSJF(procs, &fairness);
+    printResults(s);
+    fairness.print();
+}
+
+// -----------------------------------------------------------------------------
+// Approximate SJF (log-scale burst buckets)
+// -----------------------------------------------------------------------------
+
+// Ready jobs filed by burst into log-scale buckets: `precision` equal-width
+// sub-buckets per power of two, FIFO within a bucket. Buckets are intrusive
+// lists threaded through one `next` array, and a two-level bitmap finds the
+// lowest non-empty bucket with two ctz, so push and pop are O(1).
+class BurstBuckets {
+public:
+    static const int MAX_PRECISION = 64;
+
+    BurstBuckets(int n, int precision)
+        : k(precision), heads(31 * precision, -1), tails(31 * precision, -1), next(n, -1) {}
+
+    // Octave o holds bursts [2^o, 2^(o+1)), split into k equal parts
+    int bucket(int bt) const {
+        int o = 31 - __builtin_clz((unsigned)bt);
+        return o * k + (int)(((long long)(bt - (1 << o)) * k) >> o);
+    }
+
+    void push(int i, int bt) {
+        int b = bucket(bt);
+        next[i] = -1;
+        if (tails[b] >= 0) next[tails[b]] = i;
+        else heads[b] = i;
+        tails[b] = i;
+        words[b / 64] |= 1ULL << (b % 64);
+        summary |= 1U << (b / 64);
+    }
+
+    // Oldest job of the lowest non-empty bucket, or -1
+    int pop() {
+        if (!summary) return -1;
+        int w = __builtin_ctz(summary);
+        int b = w * 64 + __builtin_ctzll(words[w]);
+        int i = heads[b];
+        heads[b] = next[i];
+        if (heads[b] < 0) {
+            tails[b] = -1;
+            words[w] &= ~(1ULL << (b % 64));
+            if (!words[w]) summary &= ~(1U << w);
+        }
+        return i;
+    }
+
+private:
+    int k;
+    vector<int> heads, tails, next;
+    unsigned long long words[31] = {};   // 31 * MAX_PRECISION bucket bits
+    unsigned summary = 0;                // Non-empty words
+};
+
+// Non-preemptive SJF on BurstBuckets; st.quantum holds the precision. Exact
+// SJF breaks ties between equal bursts by arrival, and this engine extends the
+// same rule to every burst within one bucket, trading precision for O(1)
+// dispatch. Nothing of the buckets is saved: they are rebuilt from the
+// unfinished processes in arrival order, which is their FIFO order anyway.
+Schedule simulateApproxSJF(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
+    int n = procs.size();
+    st.started = true;
+    notifyStart(st, obs);
+
+    int &time = st.time, &completedCount = st.completedCount;
+    GanttChart &gantt = st.gantt;
+
+    vector<int> byArrival(n);
+    for (int i = 0; i < n; i++) byArrival[i] = i;
+    stable_sort(byArrival.begin(), byArrival.end(), [&](int a, int b){
+        return procs[a].at < procs[b].at;
+    });
+    BurstBuckets ready(n, st.quantum);
+    int next = 0;
+
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
+
+        // 1. File new arrivals, then take the oldest job of the lowest bucket
+        for (; next < n && procs[byArrival[next]].at <= time; next++) {
+            int i = byArrival[next];
+            if (procs[i].rem_bt > 0) ready.push(i, procs[i].rem_bt);
+        }
+        int idx = ready.pop();
+
+        if (idx == -1) {
+            // 2. CPU is IDLE until the next arrival
+            if (next == n) break;
+            gantt.push(time, 0);
+            time = procs[byArrival[next]].at; // Jump time directly
+        } else {
+            // 3. Execute the job (non-preemptive)
+            if (obs) obs->onDispatch(time, procs[idx]);
+            if (procs[idx].rt < 0) procs[idx].rt = time - procs[idx].at;
+            gantt.push(time, procs[idx].pid);
+            time += procs[idx].rem_bt;
+            procs[idx].rem_bt = 0;
+
+            procs[idx].ct = time;
+            procs[idx].tat = procs[idx].ct - procs[idx].at;
+            procs[idx].wt = procs[idx].tat - procs[idx].bt;
+            completedCount++;
+            if (obs) obs->onComplete(time, procs[idx]);
         }
     }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time);
+    if (obs) obs->onFinish(time);
+
+    return {"SJF - Approximate (" + to_string(st.quantum) + " buckets/octave)", procs, move(gantt)};
+}
 
-    printResults(procs, timeline, blocks, "SJF - Non Preemptive");
+Schedule runApproxSJF(vector<Process> procs, int precision, SimObserver* obs = nullptr) {
+    SimState st("asjf", move(procs), precision);
+    return simulateApproxSJF(st, obs);
 }
 
 // -----------------------------------------------------------------------------
 // Priority Scheduling Non-Preemptive
 // -----------------------------------------------------------------------------
 
-void PriorityScheduling(vector<Process> procs) {
+Schedule simulatePriorityScheduling(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
     int n = procs.size();
-    vector<bool> completed(n, false);
-    int time = 0, completedCount = 0;
-    vector<int> timeline;
-    vector<string> blocks;
-    timeline.push_back(0);
+    if (!st.started) {
+        st.completed.assign(n, false);
+        st.started = true;
+    }
+    notifyStart(st, obs);
 
-    while (completedCount < n) {
+    vector<char> &completed = st.completed;
+    int &time = st.time, &completedCount = st.completedCount;
+    GanttChart &gantt = st.gantt;
+
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
         int idx = -1;
         // Selection criteria: MINIMUM priority value (highest priority)
         int minPriority = INT_MAX;
@@ -244,18 +1223,19 @@ void PriorityScheduling(vector<Process> procs) {
             }
 
             if (next_arrival_time != INT_MAX) {
-                blocks.push_back("IDLE");
+                gantt.push(time, 0);
                 time = next_arrival_time;
-                timeline.push_back(time);
             } else {
                 break;
             }
         } else {
             // 3. Execute the highest priority job (non-preemptive)
             
-            blocks.push_back("P" + to_string(procs[idx].pid));
-            time += procs[idx].bt;
-            timeline.push_back(time);
+            if (obs) obs->onDispatch(time, procs[idx]);
+            if (procs[idx].rt < 0) procs[idx].rt = time - procs[idx].at;
+            gantt.push(time, procs[idx].pid);
+            time += procs[idx].rem_bt;
+            procs[idx].rem_bt = 0;
 
             // Calculate metrics and mark as completed
             procs[idx].ct = time;
@@ -263,168 +1243,512 @@ void PriorityScheduling(vector<Process> procs) {
             procs[idx].wt = procs[idx].tat - procs[idx].bt;
             completed[idx] = true;
             completedCount++;
+            if (obs) obs->onComplete(time, procs[idx]);
         }
     }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time);
+    if (obs) obs->onFinish(time);
+
+    return {"Priority Scheduling (Non-Preemptive)", procs, move(gantt)};
+}
+
+Schedule runPriorityScheduling(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("priority", move(procs));
+    return simulatePriorityScheduling(st, obs);
+}
 
-    printResults(procs, timeline, blocks, "Priority Scheduling (Non-Preemptive)");
+void PriorityScheduling(vector<Process> procs) {
+    FairnessTracker fairness;
+    Schedule s = runPriorityScheduling(procs, &fairness);
+    printResults(s);
+    fairness.print();
 }
 
 // -----------------------------------------------------------------------------
-// SRTF Preemptive Scheduling
+// Burst Prediction
 // -----------------------------------------------------------------------------
 
-void SRTF(vector<Process> procs) {
-    int n = procs.size();
-    int time = 0;
-    int completedCount = 0;
-    
-    // Ensure all rem_bt are correctly initialized
-    for(auto& p : procs) {
-        p.rem_bt = p.bt;
+// Guesses a process's CPU burst the way a real scheduler must, from the bursts
+// its task has completed so far (Process::task; rows without one are a task of
+// their own). Engines call predict() once per process when it arrives and
+// observe() when it completes; the schedule follows the predictions while the
+// metrics still come from the actual bt.
+class BurstPredictor {
+public:
+    virtual ~BurstPredictor() {}
+    virtual int predict(const Process& p) = 0;
+    virtual void observe(const Process& p) = 0;
+};
+
+// Exponential averaging: tau' = alpha * t + (1 - alpha) * tau per task,
+// starting from `initial`. alpha = 1 predicts the last burst. O(1) per call.
+class ExponentialAverage : public BurstPredictor {
+public:
+    ExponentialAverage(double a, double t0) : alpha(a), initial(t0) {}
+
+    int predict(const Process& p) override {
+        auto it = p.task ? tau.find(p.task) : tau.end();
+        return max(1, (int)lround(it == tau.end() ? initial : it->second));
+    }
+
+    void observe(const Process& p) override {
+        if (!p.task) return;
+        double &t = tau.emplace(p.task, initial).first->second;
+        t = alpha * p.bt + (1 - alpha) * t;
+    }
+
+private:
+    double alpha, initial;
+    unordered_map<int, double> tau;
+};
+
+// Knows the true burst, as SJF / SRTF do; psjf / psrtf with it reproduce them
+class OraclePredictor : public BurstPredictor {
+public:
+    int predict(const Process& p) override { return p.bt; }
+    void observe(const Process&) override {}
+};
+
+// Predictor used by psjf / psrtf runs, set with --predict
+string predictorSpec = "ema:0.5";
+
+// "ema:<alpha>[:<initial>]", "last[:<initial>]" or "oracle"; null if invalid.
+// The initial guess defaults to 10.
+unique_ptr<BurstPredictor> makePredictor(const string& spec) {
+    vector<string> parts;
+    stringstream ss(spec);
+    string part;
+    while (getline(ss, part, ':')) parts.push_back(part);
+    if (parts.empty()) return nullptr;
+
+    if (parts[0] == "oracle" && parts.size() == 1) return unique_ptr<BurstPredictor>(new OraclePredictor());
+    double alpha;
+    size_t next;
+    if (parts[0] == "ema" && parts.size() >= 2 && parts.size() <= 3) {
+        alpha = atof(parts[1].c_str());
+        next = 2;
+    } else if (parts[0] == "last" && parts.size() <= 2) {
+        alpha = 1;
+        next = 1;
+    } else {
+        return nullptr;
+    }
+    double initial = next < parts.size() ? atof(parts[next].c_str()) : 10;
+    if (alpha <= 0 || alpha > 1 || initial < 1) return nullptr;
+    return unique_ptr<BurstPredictor>(new ExponentialAverage(alpha, initial));
+}
+
+// Predictor for a run, fixed in st.predictor when the run first starts. Like
+// the ready sets it is rebuilt from the state rather than saved: the bursts
+// completed so far are replayed in completion order, which is all it has seen.
+unique_ptr<BurstPredictor> startPredictor(SimState &st) {
+    if (st.predictor.empty()) st.predictor = predictorSpec;
+    unique_ptr<BurstPredictor> predictor = makePredictor(st.predictor);
+    if (!predictor) predictor = makePredictor("ema:0.5");
+    vector<const Process*> done;
+    for (const auto &p : st.procs) {
+        if (p.ct > 0) done.push_back(&p);
+    }
+    sort(done.begin(), done.end(), [](const Process* a, const Process* b){
+        return a->ct < b->ct;
+    });
+    for (const Process* p : done) predictor->observe(*p);
+    return predictor;
+}
+
+// Predicted burst still to run; 0 once a process outlives its prediction
+int predictedRemaining(const Process& p) {
+    return max(p.predicted - (p.bt - p.rem_bt), 0);
+}
+
+// -----------------------------------------------------------------------------
+// SRTF Preemptive Scheduling
+// -----------------------------------------------------------------------------
+
+// Ready set of a preemptive engine: the arrived, unfinished processes, keyed by
+// readyKey() with the process index breaking ties, so all three forms pick the
+// same process. SRTF keys on (rem_bt, at); a preemptive priority policy would
+// key on (priority, at). Selected with --ready.
+string readyStructure = "segtree";
+
+const unsigned long long NOT_READY = ULLONG_MAX;
+
+unsigned long long readyKey(int primary, int at) {
+    return (unsigned long long)primary << 32 | (unsigned)at;
+}
+
+// Linear scan over all processes: O(n) per decision
+class ScanReady {
+public:
+    ScanReady(int n) : keys(n, NOT_READY) {}
+    void insert(int i, unsigned long long key) { keys[i] = key; }
+    void update(int i, unsigned long long key) { keys[i] = key; }
+    void erase(int i) { keys[i] = NOT_READY; }
+    int top() const {
+        int best = -1;
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] != NOT_READY && (best < 0 || keys[i] < keys[best])) best = i;
+        }
+        return best;
+    }
+
+private:
+    vector<unsigned long long> keys;
+};
+
+// Indexed binary heap: positions are tracked so the running process can be
+// re-keyed or removed in place, O(log n)
+class HeapReady {
+public:
+    HeapReady(int n) : keys(n), pos(n, -1) {}
+
+    void insert(int i, unsigned long long key) {
+        keys[i] = key;
+        pos[i] = heap.size();
+        heap.push_back(i);
+        up(pos[i]);
+    }
+
+    void update(int i, unsigned long long key) {
+        keys[i] = key;
+        up(pos[i]);
+        down(pos[i]);
+    }
+
+    void erase(int i) {
+        int p = pos[i];
+        int last = heap.back();
+        heap.pop_back();
+        pos[i] = -1;
+        if (p < (int)heap.size()) {
+            heap[p] = last;
+            pos[last] = p;
+            up(p);
+            down(pos[last]);
+        }
+    }
+
+    int top() const { return heap.empty() ? -1 : heap[0]; }
+
+private:
+    vector<unsigned long long> keys;
+    vector<int> pos, heap;
+
+    bool before(int a, int b) const {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    }
+
+    void up(int p) {
+        int i = heap[p];
+        while (p > 0 && before(i, heap[(p - 1) / 2])) {
+            heap[p] = heap[(p - 1) / 2];
+            pos[heap[p]] = p;
+            p = (p - 1) / 2;
+        }
+        heap[p] = i;
+        pos[i] = p;
+    }
+
+    void down(int p) {
+        int i = heap[p];
+        int n = heap.size();
+        while (2 * p + 1 < n) {
+            int c = 2 * p + 1;
+            if (c + 1 < n && before(heap[c + 1], heap[c])) c++;
+            if (!before(heap[c], i)) break;
+            heap[p] = heap[c];
+            pos[heap[p]] = p;
+            p = c;
+        }
+        heap[p] = i;
+        pos[i] = p;
+    }
+};
+
+// Min segment tree over process indices. Each node holds the smallest key
+// below it and that leaf's index, side by side in one array; ties go to the
+// left child, i.e. the lower index. Every operation walks one leaf-to-root
+// path and the argmin is read at the root.
+class SegmentTreeReady {
+public:
+    SegmentTreeReady(int n) {
+        while (leaves < n) leaves <<= 1;
+        nodes.assign(2 * leaves, {NOT_READY, -1});
+        for (int i = 0; i < leaves; i++) nodes[leaves + i].index = i;
+    }
+
+    void insert(int i, unsigned long long key) { set(i, key); }
+    void update(int i, unsigned long long key) { set(i, key); }
+    void erase(int i) { set(i, NOT_READY); }
+    int top() const { return nodes[1].key == NOT_READY ? -1 : nodes[1].index; }
+
+private:
+    struct Node {
+        unsigned long long key;
+        int index;
+    };
+    int leaves = 1;
+    vector<Node> nodes;
+
+    void set(int i, unsigned long long key) {
+        int p = leaves + i;
+        nodes[p].key = key;
+        for (p >>= 1; p > 0; p >>= 1) {
+            const Node &l = nodes[2 * p], &r = nodes[2 * p + 1];
+            nodes[p] = r.key < l.key ? r : l;
+        }
+    }
+};
+
+// Runs on any ready set. Nothing but an arrival can preempt the running
+// process, so it runs in one bulk step up to its completion, the next arrival
+// or pauseAt, whichever comes first; the decisions match those of single-unit
+// steps. With a predictor (psrtf) processes are keyed by predicted remaining
+// burst instead of the true one.
+template <class Ready>
+Schedule simulateSRTFWith(SimState &st, SimObserver* obs, Checkpointer* ckpt, BurstPredictor* predictor = nullptr) {
+    vector<Process> &procs = st.procs;
+    int n = procs.size();
+    int &time = st.time;
+    int &completedCount = st.completedCount;
+    
+    // Ensure all rem_bt are correctly initialized
+    if (!st.started) {
+        for(auto& p : procs) {
+            p.rem_bt = p.bt;
+        }
+        st.started = true;
     }
 
     // Gantt Chart tracking variables
-    vector<int> timeline = {0};
-    vector<string> blocks = {};
-    string last_block_id = ""; // Tracks the process that ran in the previous time unit
+    GanttChart &gantt = st.gantt;
+    string &last_block_id = st.lastBlock; // Tracks the process that ran in the previous time unit
+    int &last_idx = st.lastIdx;           // Index of that process while it is still unfinished
+    notifyStart(st, obs);
 
-    while (completedCount < n) {
-        int min_rem_bt = INT_MAX;
-        int shortest_idx = -1;
-        
-        // 1. Find the process with the shortest remaining time in the ready queue
-        for (int i = 0; i < n; i++) {
-            if (procs[i].at <= time && procs[i].rem_bt > 0) {
-                if (procs[i].rem_bt < min_rem_bt) {
-                    min_rem_bt = procs[i].rem_bt;
-                    shortest_idx = i;
-                }
-                // Tie-breaker: FCFS for equal remaining times
-                else if (procs[i].rem_bt == min_rem_bt) {
-                    if (shortest_idx != -1 && procs[i].at < procs[shortest_idx].at) {
-                        shortest_idx = i;
-                    }
-                }
-            }
+    // Processes in arrival order; the ready set is rebuilt from the state, so
+    // a resumed run needs nothing extra from the checkpoint
+    vector<int> byArrival(n);
+    for (int i = 0; i < n; i++) byArrival[i] = i;
+    stable_sort(byArrival.begin(), byArrival.end(), [&](int a, int b){
+        return procs[a].at < procs[b].at;
+    });
+    Ready ready(n);
+    int next = 0;
+    auto key = [&](const Process &p) {
+        return readyKey(predictor ? predictedRemaining(p) : p.rem_bt, p.at);
+    };
+
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
+
+        // 1. Admit arrivals, then take the shortest remaining time
+        for (; next < n && procs[byArrival[next]].at <= time; next++) {
+            Process &p = procs[byArrival[next]];
+            if (p.rem_bt == 0) continue;
+            if (predictor && p.predicted == 0) p.predicted = predictor->predict(p);
+            ready.insert(byArrival[next], key(p));
         }
+        int shortest_idx = ready.top();
 
         if (shortest_idx == -1) {
-            // 2. CPU is IDLE
-            int next_arrival_time = INT_MAX;
-            bool found_next = false;
-            
-            for(int i = 0; i < n; i++) {
-                if(procs[i].rem_bt > 0) {
-                    next_arrival_time = min(next_arrival_time, procs[i].at);
-                    found_next = true;
-                }
+            // 2. CPU is IDLE until the next arrival
+            if (next == n) break;
+            // Only push "IDLE" if the previous block wasn't IDLE
+            if (last_block_id != "IDLE") {
+                gantt.push(time, 0);
             }
+            time = procs[byArrival[next]].at; // Jump time
+            last_block_id = "IDLE";
+            continue;
+        }
 
-            if (found_next) {
-                // Only push "IDLE" if the previous block wasn't IDLE
-                if (last_block_id != "IDLE") {
-                    blocks.push_back("IDLE");
-                    timeline.push_back(time);
-                }
-                time = next_arrival_time; // Jump time
-                last_block_id = "IDLE";
-            } else {
-                break;
-            }
+        // 3. Process Execution
+        Process &p = procs[shortest_idx];
+        string current_block_id = "P" + to_string(p.pid);
+        
+        // Preemption Check: If the process is changing (new shortest or transition from IDLE)
+        if (current_block_id != last_block_id) {
+            if (obs && last_idx != -1) obs->onPreempt(time, procs[last_idx]);
+            if (obs) obs->onDispatch(time, p);
+            if (p.rt < 0) p.rt = time - p.at;
+            gantt.push(time, p.pid);
         }
-        else {
-            // 3. Process Execution for 1 unit
-            string current_block_id = "P" + to_string(procs[shortest_idx].pid);
-            
-            // Preemption Check: If the process is changing (new shortest or transition from IDLE)
-            if (current_block_id != last_block_id) {
-                blocks.push_back(current_block_id);
-                // Push current time only if it's the start of a new block
-                if (last_block_id != "IDLE") {
-                    timeline.push_back(time);
-                }
-            }
+        
+        last_block_id = current_block_id;
+        last_idx = shortest_idx;
+
+        int run = p.rem_bt;
+        if (next < n) run = min(run, procs[byArrival[next]].at - time);
+        run = min(run, st.pauseAt - time);
+        p.rem_bt -= run;
+        time += run;
+
+        // 4. Completion Check
+        if (p.rem_bt == 0) {
+            completedCount++;
+            ready.erase(shortest_idx);
             
-            last_block_id = current_block_id;
+            // Finalize metrics
+            p.ct = time;
+            p.tat = p.ct - p.at;
+            p.wt = p.tat - p.bt;
+            if (predictor) predictor->observe(p);
+            if (obs) obs->onComplete(time, p);
             
-            // Execute for 1 unit
-            procs[shortest_idx].rem_bt--;
-            time++;
-
-            // 4. Completion Check
-            if (procs[shortest_idx].rem_bt == 0) {
-                completedCount++;
-                
-                // Finalize metrics
-                procs[shortest_idx].ct = time;
-                procs[shortest_idx].tat = procs[shortest_idx].ct - procs[shortest_idx].at;
-                procs[shortest_idx].wt = procs[shortest_idx].tat - procs[shortest_idx].bt;
-                
-                // Mark completion on the Gantt chart
-                timeline.push_back(time);
-                last_block_id = ""; // Reset block ID to trigger new block on next iteration
-            }
+            last_block_id = ""; // Reset block ID to trigger new block on next iteration
+            last_idx = -1;
+        } else {
+            ready.update(shortest_idx, key(p));
         }
     }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time); // End of the last block
+    if (obs) obs->onFinish(time);
 
-    // --- Gantt Chart Cleanup (Merging consecutive identical blocks for cleaner visual) ---
-    vector<int> final_timeline;
-    vector<string> final_blocks;
-    if (!blocks.empty()) {
-        final_blocks.push_back(blocks[0]);
-        final_timeline.push_back(timeline[0]);
-        
-        for (size_t i = 1; i < blocks.size(); ++i) {
-            if (blocks[i] != final_blocks.back()) {
-                final_timeline.push_back(timeline[i]);
-                final_blocks.push_back(blocks[i]);
-            }
+    string name = predictor ? "SRTF - Predicted Bursts (" + st.predictor + ")" : "SRTF - Preemptive SJF";
+    return {name, procs, move(gantt)};
+}
+
+Schedule simulateSRTF(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    unique_ptr<BurstPredictor> predictor;
+    if (st.algo == "psrtf") predictor = startPredictor(st);
+    if (readyStructure == "scan") return simulateSRTFWith<ScanReady>(st, obs, ckpt, predictor.get());
+    if (readyStructure == "heap") return simulateSRTFWith<HeapReady>(st, obs, ckpt, predictor.get());
+    return simulateSRTFWith<SegmentTreeReady>(st, obs, ckpt, predictor.get());
+}
+
+Schedule runSRTF(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("srtf", move(procs));
+    return simulateSRTF(st, obs);
+}
+
+void SRTF(vector<Process> procs) {
+    FairnessTracker fairness;
+    Schedule s = runSRTF(procs, &fairness);
+    printResults(s);
+    fairness.print();
+}
+
+Schedule runPredictedSRTF(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("psrtf", move(procs));
+    return simulateSRTF(st, obs);
+}
+
+// -----------------------------------------------------------------------------
+// SJF with Predicted Bursts
+// -----------------------------------------------------------------------------
+
+// Non-preemptive SJF ordered by predicted burst. Each arrival is predicted
+// once and filed in an indexed heap, so a dispatch costs one O(1) prediction
+// plus O(log n); ties fall back to arrival, then input order, as in SJF. The
+// heap and predictor are rebuilt from the state, as in SRTF.
+Schedule simulatePredictedSJF(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
+    int n = procs.size();
+    st.started = true;
+    unique_ptr<BurstPredictor> predictor = startPredictor(st);
+    notifyStart(st, obs);
+
+    int &time = st.time, &completedCount = st.completedCount;
+    GanttChart &gantt = st.gantt;
+
+    vector<int> byArrival(n);
+    for (int i = 0; i < n; i++) byArrival[i] = i;
+    stable_sort(byArrival.begin(), byArrival.end(), [&](int a, int b){
+        return procs[a].at < procs[b].at;
+    });
+    HeapReady ready(n);
+    int next = 0;
+
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
+
+        // 1. Predict and file new arrivals, then take the shortest prediction
+        for (; next < n && procs[byArrival[next]].at <= time; next++) {
+            Process &p = procs[byArrival[next]];
+            if (p.rem_bt == 0) continue;
+            if (p.predicted == 0) p.predicted = predictor->predict(p);
+            ready.insert(byArrival[next], readyKey(predictedRemaining(p), p.at));
         }
-        if (final_timeline.back() != timeline.back()) {
-            final_timeline.push_back(timeline.back());
+        int idx = ready.top();
+
+        if (idx == -1) {
+            // 2. CPU is IDLE until the next arrival
+            if (next == n) break;
+            gantt.push(time, 0);
+            time = procs[byArrival[next]].at; // Jump time directly
+        } else {
+            // 3. Execute the job to completion; its actual burst is what counts
+            ready.erase(idx);
+            if (obs) obs->onDispatch(time, procs[idx]);
+            if (procs[idx].rt < 0) procs[idx].rt = time - procs[idx].at;
+            gantt.push(time, procs[idx].pid);
+            time += procs[idx].rem_bt;
+            procs[idx].rem_bt = 0;
+
+            procs[idx].ct = time;
+            procs[idx].tat = procs[idx].ct - procs[idx].at;
+            procs[idx].wt = procs[idx].tat - procs[idx].bt;
+            completedCount++;
+            predictor->observe(procs[idx]);
+            if (obs) obs->onComplete(time, procs[idx]);
         }
     }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time);
+    if (obs) obs->onFinish(time);
 
-    printResults(procs, final_timeline, final_blocks, "SRTF - Preemptive SJF");
+    return {"SJF - Predicted Bursts (" + st.predictor + ")", procs, move(gantt)};
+}
+
+Schedule runPredictedSJF(vector<Process> procs, SimObserver* obs = nullptr) {
+    SimState st("psjf", move(procs));
+    return simulatePredictedSJF(st, obs);
 }
 
 // -----------------------------------------------------------------------------
 // Round Robin Scheduling
 // -----------------------------------------------------------------------------
 
-void RoundRobin(vector<Process> procs, int quantum) {
+Schedule simulateRoundRobin(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    vector<Process> &procs = st.procs;
     int n = procs.size();
-    int time = 0;
-    int completedCount = 0;
-    
-    // Set up the ready queue (stores process indices)
-    queue<int> readyQueue;
-    vector<bool> inQueue(n, false); // To track if a process is already in the queue
+    int quantum = st.quantum;
+    int &time = st.time;
+    int &completedCount = st.completedCount;
     
-    // Sort processes by arrival time to easily check for arrivals
-    sort(procs.begin(), procs.end(), [](Process &a, Process &b){
-        return a.at < b.at;
-    });
+    if (!st.started) {
+        // Sort processes by arrival time to easily check for arrivals
+        stable_sort(procs.begin(), procs.end(), [](const Process &a, const Process &b){
+            return a.at < b.at;
+        });
 
-    // Remap PIDs to indices for queue/vector access
-    vector<int> pid_to_idx(procs.back().pid + 1, -1);
-    for(int i = 0; i < n; ++i) {
-        pid_to_idx[procs[i].pid] = i;
-        procs[i].rem_bt = procs[i].bt; // Reset remaining burst time
+        for(int i = 0; i < n; ++i) {
+            procs[i].rem_bt = procs[i].bt; // Reset remaining burst time
+        }
+        st.inQueue.assign(n, false);
+        st.started = true;
     }
+    notifyStart(st, obs);
+
+    // Set up the ready queue (stores process indices)
+    deque<int> &readyQueue = st.readyQueue;
+    vector<char> &inQueue = st.inQueue; // To track if a process is already in the queue
     
     // Gantt Chart tracking variables
-    vector<int> timeline = {0};
-    vector<string> blocks = {};
-    string last_block_id = "";
-    int next_proc_to_arrive = 0; // Index of the next process to check for arrival
+    GanttChart &gantt = st.gantt;
+    string &last_block_id = st.lastBlock;
+    int &next_proc_to_arrive = st.nextArrival; // Index of the next process to check for arrival
 
-    while (completedCount < n) {
+    while (completedCount < n && time < st.pauseAt) {
+        if (ckpt) ckpt->poll(st);
         
         // 1. Add all newly arrived processes to the ready queue (FCFS order)
         for (int i = next_proc_to_arrive; i < n; ++i) {
             if (procs[i].at <= time && !inQueue[i]) {
-                readyQueue.push(i);
+                readyQueue.push_back(i);
                 inQueue[i] = true;
                 next_proc_to_arrive = i + 1; // Optimization: next arrival check starts here
             } else if (procs[i].at > time) {
@@ -449,8 +1773,7 @@ void RoundRobin(vector<Process> procs, int quantum) {
             if (found_next) {
                 // Only push "IDLE" if the previous block wasn't IDLE
                 if (last_block_id != "IDLE") {
-                    blocks.push_back("IDLE");
-                    timeline.push_back(time);
+                    gantt.push(time, 0);
                 }
                 time = next_arrival_time; // Jump time
                 last_block_id = "IDLE";
@@ -460,19 +1783,18 @@ void RoundRobin(vector<Process> procs, int quantum) {
         } else {
             // 3. Execute the process at the front of the queue
             int current_proc_idx = readyQueue.front();
-            readyQueue.pop();
+            readyQueue.pop_front();
             inQueue[current_proc_idx] = false; // Mark as not in queue (it's running)
 
             int execution_time = min(quantum, procs[current_proc_idx].rem_bt);
             string current_block_id = "P" + to_string(procs[current_proc_idx].pid);
             
+            if (obs) obs->onDispatch(time, procs[current_proc_idx]);
+            if (procs[current_proc_idx].rt < 0) procs[current_proc_idx].rt = time - procs[current_proc_idx].at;
+
             // Start of a new block in Gantt Chart
             if (current_block_id != last_block_id) {
-                blocks.push_back(current_block_id);
-                // The time will be pushed at the start of the block or after IDLE
-                if (last_block_id != "IDLE") {
-                    timeline.push_back(time);
-                }
+                gantt.push(time, procs[current_proc_idx].pid);
             }
             last_block_id = current_block_id;
 
@@ -483,7 +1805,7 @@ void RoundRobin(vector<Process> procs, int quantum) {
             // 4. Check for arrivals *during* execution (important for RR)
             for (int i = next_proc_to_arrive; i < n; ++i) {
                 if (procs[i].at <= time && !inQueue[i]) {
-                    readyQueue.push(i);
+                    readyQueue.push_back(i);
                     inQueue[i] = true;
                     next_proc_to_arrive = i + 1;
                 } else if (procs[i].at > time) {
@@ -497,51 +1819,3894 @@ void RoundRobin(vector<Process> procs, int quantum) {
                 procs[current_proc_idx].ct = time;
                 procs[current_proc_idx].tat = procs[current_proc_idx].ct - procs[current_proc_idx].at;
                 procs[current_proc_idx].wt = procs[current_proc_idx].tat - procs[current_proc_idx].bt;
+                if (obs) obs->onComplete(time, procs[current_proc_idx]);
                 
-                timeline.push_back(time);
                 last_block_id = ""; // Force a new block start after completion
             } else {
                 // Process Preempted (not completed)
-                readyQueue.push(current_proc_idx);
+                if (obs) obs->onPreempt(time, procs[current_proc_idx]);
+                readyQueue.push_back(current_proc_idx);
                 inQueue[current_proc_idx] = true; // Put back into the queue
                 
-                timeline.push_back(time);
                 last_block_id = ""; // Force a new block start after preemption
             }
         }
     }
+    if (completedCount < n) return {}; // Paused
+    gantt.finish(time); // End of the last block
+    if (obs) obs->onFinish(time);
     
     // --- Final process vector must be re-sorted by PID for printResults ---
     sort(procs.begin(), procs.end(), [](Process &a, Process &b){
         return a.pid < b.pid;
     });
 
-    // --- Gantt Chart Cleanup (Merging consecutive identical blocks for cleaner visual) ---
-    vector<int> final_timeline;
-    vector<string> final_blocks;
-    if (!blocks.empty()) {
-        final_blocks.push_back(blocks[0]);
-        final_timeline.push_back(timeline[0]);
-        
-        for (size_t i = 1; i < blocks.size(); ++i) {
-            if (blocks[i] != final_blocks.back()) {
-                final_timeline.push_back(timeline[i]);
-                final_blocks.push_back(blocks[i]);
-            }
+    return {"Round Robin (RR)", procs, move(gantt)};
+}
+
+Schedule runRoundRobin(vector<Process> procs, int quantum, SimObserver* obs = nullptr) {
+    SimState st("rr", move(procs), quantum);
+    return simulateRoundRobin(st, obs);
+}
+
+void RoundRobin(vector<Process> procs, int quantum) {
+    FairnessTracker fairness;
+    Schedule s = runRoundRobin(procs, quantum, &fairness);
+    printResults(s);
+    fairness.print();
+}
+
+// -----------------------------------------------------------------------------
+// Workload File Input
+// -----------------------------------------------------------------------------
+
+// Parses one "AT,BT[,PRI[,TASK]]" row held in [s, end), without needing a
+// terminating NUL. Blank lines, '#' comments and a non-numeric header are
+// reported as skipped (returns 0); invalid rows return -1.
+int parseWorkloadRow(const char* s, const char* end, int &at, int &bt, int &pri, int &task) {
+    while (s < end && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+    if (s == end || *s == '#') return 0;
+    if (!isdigit((unsigned char)*s) && *s != '-') return 0;
+
+    long long vals[4] = {0, 0, 0, 0};
+    int count = 0;
+    while (s < end && count < 4) {
+        while (s < end && (*s == ' ' || *s == '\t')) s++;
+        bool negative = s < end && *s == '-';
+        if (negative) s++;
+        if (s == end || !isdigit((unsigned char)*s)) return -1;
+        long long v = 0;
+        while (s < end && isdigit((unsigned char)*s)) {
+            v = v * 10 + (*s++ - '0');
+            if (v > INT_MAX) return -1;
+        }
+        vals[count++] = negative ? -v : v;
+        while (s < end && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+        if (s < end && *s == ',') s++;
+    }
+    if (count < 2) return -1;
+
+    at = (int)vals[0];
+    bt = (int)vals[1];
+    pri = (int)vals[2];
+    task = (int)vals[3];
+    // Same constraints as the interactive input in main()
+    if (at < 0 || bt <= 0 || pri < 0 || task < 0) return -1;
+    return 1;
+}
+
+int parseWorkloadLine(const string& line, int &at, int &bt, int &pri, int &task) {
+    return parseWorkloadRow(line.data(), line.data() + line.size(), at, bt, pri, task);
+}
+
+// Reads CSV workload rows; PIDs are assigned in input order starting at 1
+bool readWorkload(istream& in, vector<Process> &procs, string &error) {
+    string line;
+    int lineNo = 0;
+    while (getline(in, line)) {
+        lineNo++;
+        int at, bt, pri, task;
+        int r = parseWorkloadLine(line, at, bt, pri, task);
+        if (r < 0) {
+            error = "Invalid workload row at line " + to_string(lineNo) + ": " + line;
+            return false;
+        }
+        if (r > 0) procs.push_back(Process(procs.size() + 1, at, bt, pri, task));
+    }
+    return true;
+}
+
+// Rows of one slice of a workload file, parsed column-wise (SoA)
+struct WorkloadChunk {
+    vector<int> at, bt, pri, task;
+    long long lines = 0;      // Lines seen in the slice, for error positions
+    long long badLine = 0;    // 1-based line within the slice of the first bad row
+    string badRow;
+};
+
+void parseWorkloadChunk(const char* s, const char* end, WorkloadChunk &chunk) {
+    // Rough row estimate so the columns rarely reallocate
+    size_t estimate = (end - s) / 8;
+    chunk.at.reserve(estimate);
+    chunk.bt.reserve(estimate);
+    chunk.pri.reserve(estimate);
+    chunk.task.reserve(estimate);
+
+    while (s < end) {
+        const char* eol = (const char*)memchr(s, '\n', end - s);
+        if (!eol) eol = end;
+        chunk.lines++;
+        int at, bt, pri, task;
+        int r = parseWorkloadRow(s, eol, at, bt, pri, task);
+        if (r < 0) {
+            chunk.badLine = chunk.lines;
+            chunk.badRow.assign(s, eol);
+            return;
+        }
+        if (r > 0) {
+            chunk.at.push_back(at);
+            chunk.bt.push_back(bt);
+            chunk.pri.push_back(pri);
+            chunk.task.push_back(task);
         }
-        if (final_timeline.back() != timeline.back()) {
-            final_timeline.push_back(timeline.back());
+        s = eol + 1;
+    }
+}
+
+// Loads a workload file with one thread per slice. The file is mapped, cut
+// at newline boundaries, and every slice is parsed and validated into its own
+// columns; slices are then written straight into their final position in
+// procs (each thread knows its offset from the row counts before it).
+// Returns 1 when loaded, -1 on an invalid row (already reported) and 0 when
+// the file cannot be mapped, e.g. a pipe, so the caller can stream it instead.
+int loadWorkloadParallel(const string& path, vector<Process> &procs, int threads) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return 0;
+    madvise(map, size, MADV_SEQUENTIAL);
+    const char* data = (const char*)map;
+
+    // Small files are not worth more than one slice per MiB
+    threads = max(1, min<int>(threads, size / (1 << 20) + 1));
+    vector<const char*> cuts(threads + 1);
+    cuts[0] = data;
+    cuts[threads] = data + size;
+    for (int i = 1; i < threads; i++) {
+        const char* c = max(cuts[i - 1], data + size / threads * i);
+        const char* nl = (const char*)memchr(c, '\n', data + size - c);
+        cuts[i] = nl ? nl + 1 : data + size;
+    }
+
+    vector<WorkloadChunk> chunks(threads);
+    vector<thread> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back([&, i]{ parseWorkloadChunk(cuts[i], cuts[i + 1], chunks[i]); });
+    }
+    for (auto &th : pool) th.join();
+    munmap(map, size);
+
+    vector<size_t> rowOffset(threads + 1, 0);
+    long long lineOffset = 0;
+    for (int i = 0; i < threads; i++) {
+        if (chunks[i].badLine) {
+            cout << "Invalid workload row at line " << lineOffset + chunks[i].badLine
+                 << ": " << chunks[i].badRow << "\n";
+            return -1;
         }
+        lineOffset += chunks[i].lines;
+        rowOffset[i + 1] = rowOffset[i] + chunks[i].at.size();
+    }
+
+    size_t base = procs.size();
+    procs.resize(base + rowOffset[threads], Process(0, 0, 0, 0));
+    pool.clear();
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back([&, i]{
+            WorkloadChunk &c = chunks[i];
+            for (size_t r = 0; r < c.at.size(); r++) {
+                size_t slot = base + rowOffset[i] + r;
+                procs[slot] = Process(slot + 1, c.at[r], c.bt[r], c.pri[r], c.task[r]);
+            }
+            // Release the slice columns as soon as they are placed
+            vector<int>().swap(c.at);
+            vector<int>().swap(c.bt);
+            vector<int>().swap(c.pri);
+            vector<int>().swap(c.task);
+        });
+    }
+    for (auto &th : pool) th.join();
+    return 1;
+}
+
+bool loadWorkload(const string& path, vector<Process> &procs) {
+    int mapped = loadWorkloadParallel(path, procs, max(1u, thread::hardware_concurrency()));
+    if (mapped != 0) return mapped > 0;
+
+    ifstream in(path);
+    if (!in) {
+        cout << "Cannot open workload file: " << path << "\n";
+        return false;
     }
 
-    printResults(procs, final_timeline, final_blocks, "Round Robin (RR)");
+    string error;
+    if (!readWorkload(in, procs, error)) {
+        cout << error << "\n";
+        return false;
+    }
+    return true;
 }
 
 // -----------------------------------------------------------------------------
-// Main Driver Function
+// Job-Class Compression
 // -----------------------------------------------------------------------------
 
-int main() {
+// A group of identical jobs (same AT, BT and priority) simulated as one entry.
+// Members of a class always run back to back, so their metrics follow an
+// arithmetic series and can be summed without visiting each job.
+struct JobClass {
+    int at;
+    int bt;
+    int priority;
+    long long count;     // Number of identical jobs in the class
+    long long done;      // Members already executed
+    long long sumCT;     // Metric sums over all members
+    long long sumTAT;
+    long long sumWT;
+    long long maxWT;
+};
+
+// Groups the jobs of a workload for `algo` (fcfs, sjf or priority). Classes
+// are in arrival order, then by the algorithm's key; jobs that tie on both
+// keep their input order, as the per-process engines break such ties by it,
+// so only rows that are identical and adjacent in that order are merged.
+vector<JobClass> compressWorkload(const vector<Process>& procs, const string& algo) {
+    vector<JobClass> classes;
+    vector<const Process*> order;
+    order.reserve(procs.size());
+    for (const auto &p : procs) order.push_back(&p);
+
+    stable_sort(order.begin(), order.end(), [&algo](const Process* a, const Process* b){
+        if (a->at != b->at) return a->at < b->at;
+        if (algo == "sjf") return a->bt < b->bt;
+        if (algo == "priority") return a->priority < b->priority;
+        return false;
+    });
+
+    for (const Process* p : order) {
+        if (!classes.empty() && classes.back().at == p->at &&
+            classes.back().bt == p->bt && classes.back().priority == p->priority) {
+            classes.back().count++;
+        } else {
+            classes.push_back({p->at, p->bt, p->priority, 1, 0, 0, 0, 0, 0});
+        }
+    }
+    return classes;
+}
+
+// Runs `k` consecutive members of class c starting at `time` and folds their
+// metrics in closed form. Returns the time at which the last member completes.
+long long runClassMembers(JobClass &c, long long k, long long time) {
+    long long firstWT = time - c.at;
+    long long wtSum = k * firstWT + (long long)c.bt * (k * (k - 1) / 2);
+
+    c.sumWT += wtSum;
+    c.sumTAT += wtSum + k * c.bt;
+    c.sumCT += wtSum + k * c.bt + k * c.at;
+    c.maxWT = max(c.maxWT, firstWT + (long long)c.bt * (k - 1));
+    c.done += k;
+    return time + k * c.bt;
+}
+
+// Finished class-level run: per-class metric sums plus the block chart
+struct ClassSchedule {
+    string algorithmName;
+    vector<JobClass> classes;
+    vector<long long> timeline;
+    vector<string> blocks;
+};
+
+void printClassResults(const ClassSchedule& s) {
+    const vector<JobClass> &classes = s.classes;
+    const vector<long long> &timeline = s.timeline;
+    const vector<string> &blocks = s.blocks;
+    const string &algorithmName = s.algorithmName;
+    int fixedWidth = 10;
+    long long idleTime = 0, jobs = 0;
+    double totalTAT = 0, totalWT = 0;
+
+    cout << "\n---------------------------------------------------------------\n";
+    cout << "\t\t" << algorithmName << " Results (Job Classes)\n";
+    cout << "---------------------------------------------------------------\n";
+
+    cout << "\nGantt Chart (" << algorithmName << "):\n";
+    for (const auto &b : blocks) {
+        cout << "| " << left << setw(fixedWidth - 2) << b;
+    }
+    cout << "|\n";
+    for (size_t i = 0; i < timeline.size(); i++) {
+        cout << left << setw(fixedWidth) << timeline[i];
+    }
+    cout << "\n\n";
+
+    cout << "CLS\tAT\tBT\tPRI\tCOUNT\tAvgCT\tAvgTAT\tAvgWT\tMaxWT\n";
+    cout << "-------------------------------------------------------------------------\n";
+    cout << fixed << setprecision(2);
+    for (size_t i = 0; i < classes.size(); i++) {
+        const JobClass &c = classes[i];
+        jobs += c.count;
+        totalTAT += c.sumTAT;
+        totalWT += c.sumWT;
+        cout << "C" << i + 1 << "\t" << c.at << "\t" << c.bt << "\t" << c.priority
+             << "\t" << c.count << "\t" << (double)c.sumCT / c.count
+             << "\t" << (double)c.sumTAT / c.count << "\t" << (double)c.sumWT / c.count
+             << "\t" << c.maxWT << "\n";
+    }
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i] == "IDLE" && i + 1 < timeline.size()) {
+            idleTime += timeline[i+1] - timeline[i];
+        }
+    }
+
+    cout << "\nJobs: " << jobs << " in " << classes.size() << " classes\n";
+    cout << "Average Turn Around Time: " << totalTAT / jobs << " units\n";
+    cout << "Average Waiting Time: " << totalWT / jobs << " units\n";
+    cout << "Total CPU Idle Time: " << idleTime << " units\n";
+}
+
+ClassSchedule runFCFSClasses(vector<JobClass> classes) {
+    // compressWorkload() already orders classes by arrival time
+    long long time = 0;
+    vector<long long> timeline = {0};
+    vector<string> blocks;
+
+    for (size_t i = 0; i < classes.size(); i++) {
+        JobClass &c = classes[i];
+        if (c.at > time) {
+            blocks.push_back("IDLE");
+            time = c.at;
+            timeline.push_back(time);
+        }
+
+        // The whole class runs as one block
+        blocks.push_back("C" + to_string(i + 1) + "x" + to_string(c.count));
+        time = runClassMembers(c, c.count, time);
+        timeline.push_back(time);
+    }
+
+    return {"FCFS", move(classes), move(timeline), move(blocks)};
+}
+
+void FCFSClasses(vector<JobClass> classes) {
+    printClassResults(runFCFSClasses(move(classes)));
+}
+
+// Shared engine for SJF and Priority over job classes. Once a class is chosen
+// its members keep winning every decision until another class arrives, so all
+// members dispatched before the next arrival are executed as one chunk.
+ClassSchedule runNonPreemptiveClasses(vector<JobClass> classes, bool byPriority, const string& algorithmName) {
+    int n = classes.size();
+    long long time = 0;
+    int nextArrival = 0;   // First class (in AT order) that has not arrived yet
+    int finished = 0;
+    int lastIdx = -1;      // Class of the previous block, for merging chunks
+    long long lastRun = 0;
+    vector<long long> timeline = {0};
+    vector<string> blocks;
+
+    while (finished < n) {
+        while (nextArrival < n && classes[nextArrival].at <= time) nextArrival++;
+
+        int idx = -1;
+        for (int i = 0; i < nextArrival; i++) {
+            if (classes[i].done == classes[i].count) continue;
+            int key = byPriority ? classes[i].priority : classes[i].bt;
+            if (idx == -1) {
+                idx = i;
+                continue;
+            }
+            int best = byPriority ? classes[idx].priority : classes[idx].bt;
+            // Tie-breaker: FCFS for equal keys
+            if (key < best || (key == best && classes[i].at < classes[idx].at)) idx = i;
+        }
+
+        if (idx == -1) {
+            // CPU is IDLE until the next class arrives
+            blocks.push_back("IDLE");
+            time = classes[nextArrival].at;
+            timeline.push_back(time);
+            lastIdx = -1;
+            continue;
+        }
+
+        JobClass &c = classes[idx];
+        long long k = c.count - c.done;
+        if (nextArrival < n) {
+            // Members starting strictly before the next arrival run unopposed
+            long long gap = classes[nextArrival].at - time;
+            k = min(k, max(1LL, (gap + c.bt - 1) / c.bt));
+        }
+
+        time = runClassMembers(c, k, time);
+
+        // Chunks of the same class that stay back to back share one block
+        if (idx == lastIdx) {
+            lastRun += k;
+            timeline.back() = time;
+            blocks.back() = "C" + to_string(idx + 1) + "x" + to_string(lastRun);
+        } else {
+            blocks.push_back("C" + to_string(idx + 1) + "x" + to_string(k));
+            timeline.push_back(time);
+            lastIdx = idx;
+            lastRun = k;
+        }
+        if (c.done == c.count) finished++;
+    }
+
+    return {algorithmName, move(classes), move(timeline), move(blocks)};
+}
+
+void NonPreemptiveClasses(vector<JobClass> classes, bool byPriority, const string& algorithmName) {
+    printClassResults(runNonPreemptiveClasses(move(classes), byPriority, algorithmName));
+}
+
+// -----------------------------------------------------------------------------
+// Schedule Index ("who ran at time t" queries)
+// -----------------------------------------------------------------------------
+
+// Parses an algorithm name for the command line: fcfs, sjf, priority, srtf,
+// rr:<quantum>, asjf[:<precision>], psjf or psrtf; the precision travels in
+// `quantum`.
+// Returns false on an unknown name or a bad quantum.
+bool parseAlgorithm(const string& spec, string &algo, int &quantum) {
+    algo = spec;
+    quantum = 0;
+    if (spec.compare(0, 3, "rr:") == 0) {
+        algo = "rr";
+        quantum = atoi(spec.c_str() + 3);
+        return quantum > 0;
+    }
+    if (spec == "asjf" || spec.compare(0, 5, "asjf:") == 0) {
+        algo = "asjf";
+        quantum = spec.size() > 5 ? atoi(spec.c_str() + 5) : 1;
+        return quantum > 0 && quantum <= BurstBuckets::MAX_PRECISION;
+    }
+    return algo == "fcfs" || algo == "sjf" || algo == "priority" || algo == "srtf" ||
+           algo == "psjf" || algo == "psrtf";
+}
+
+Schedule runAlgorithm(const string& algo, const vector<Process>& procs, int quantum, SimObserver* obs = nullptr) {
+    if (algo == "fcfs") return runFCFS(procs, obs);
+    if (algo == "sjf") return runSJF(procs, obs);
+    if (algo == "priority") return runPriorityScheduling(procs, obs);
+    if (algo == "srtf") return runSRTF(procs, obs);
+    if (algo == "asjf") return runApproxSJF(procs, quantum, obs);
+    if (algo == "psjf") return runPredictedSJF(procs, obs);
+    if (algo == "psrtf") return runPredictedSRTF(procs, obs);
+    return runRoundRobin(procs, quantum, obs);
+}
+
+// Runs (or continues) the engine named by st.algo
+Schedule simulateState(SimState &st, SimObserver* obs = nullptr, Checkpointer* ckpt = nullptr) {
+    if (st.algo == "fcfs") return simulateFCFS(st, obs, ckpt);
+    if (st.algo == "sjf") return simulateSJF(st, obs, ckpt);
+    if (st.algo == "priority") return simulatePriorityScheduling(st, obs, ckpt);
+    if (st.algo == "srtf" || st.algo == "psrtf") return simulateSRTF(st, obs, ckpt);
+    if (st.algo == "psjf") return simulatePredictedSJF(st, obs, ckpt);
+    if (st.algo == "asjf") return simulateApproxSJF(st, obs, ckpt);
+    return simulateRoundRobin(st, obs, ckpt);
+}
+
+// Runs fcfs, sjf and priority both over job classes and per process and
+// compares the totals; any difference is a bug in the class engines
+int classCheckCommand(const string& path) {
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    bool ok = true;
+    for (const string algo : {"fcfs", "sjf", "priority"}) {
+        vector<JobClass> classes = compressWorkload(procs, algo);
+        size_t classCount = classes.size();
+        ClassSchedule c = algo == "fcfs" ? runFCFSClasses(move(classes))
+                        : runNonPreemptiveClasses(move(classes), algo == "priority", algo);
+        long long classTAT = 0, classWT = 0;
+        for (const auto &jc : c.classes) {
+            classTAT += jc.sumTAT;
+            classWT += jc.sumWT;
+        }
+
+        Schedule s = runAlgorithm(algo, procs, 0);
+        long long tat = 0, wt = 0;
+        for (const auto &p : s.procs) {
+            tat += p.tat;
+            wt += p.wt;
+        }
+
+        bool match = tat == classTAT && wt == classWT && s.gantt.endTime() == c.timeline.back();
+        ok = ok && match;
+        cout << algo << ": " << procs.size() << " jobs in " << classCount << " classes, "
+             << (match ? "match" : "MISMATCH") << " (total TAT " << classTAT << " vs " << tat
+             << ", WT " << classWT << " vs " << wt << ", end " << c.timeline.back() << " vs "
+             << s.gantt.endTime() << ")\n";
+    }
+    return ok ? 0 : 1;
+}
+
+int queryCommand(const string& spec, const string& path, int t1, int t2, bool isRange) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    Schedule s = runAlgorithm(algo, procs, quantum);
+    const GanttChart &g = s.gantt;
+    GanttChart::Segment seg;
+
+    cout << s.algorithmName << ": " << g.size() << " segments (" << g.bytes() / 1024 << " KiB";
+    if (g.diskBytes() > 0) cout << ", " << g.diskBytes() / 1024 << " KiB spilled";
+    cout << ")\n";
+    if (!isRange) {
+        if (!g.find(t1, seg)) {
+            if (ganttReadFailed) return 1;
+            cout << "t=" << t1 << ": outside schedule\n";
+        }
+        else cout << "t=" << t1 << ": " << segmentLabel(seg.pid) << " ["
+                  << seg.start << ", " << seg.end << ")\n";
+        return 0;
+    }
+
+    GanttChart::Cursor c = g.seek(t1);
+    while (t1 < t2 && c.next(seg) && seg.start < t2) {
+        cout << segmentLabel(seg.pid) << "\t[" << seg.start << ", " << seg.end << ")\n";
+    }
+    return c.failed() ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// System Time Series (ready queue length, utilization, throughput)
+// -----------------------------------------------------------------------------
+
+// One fixed-size window of the system view
+struct WindowSample {
+    int start;          // Window start time
+    float avgQueue;     // Time-averaged ready queue length
+    int maxQueue;       // Longest ready queue seen in the window
+    float utilization;  // Fraction of the window the CPU was busy
+    int arrivals;
+    int completions;    // Throughput of the window
+};
+
+// Builds the window series from engine events. The system state only changes
+// at events, so each event closes out the constant stretch since the previous
+// one instead of sampling every tick.
+class TimeSeriesRecorder : public SimObserver {
+public:
+    vector<WindowSample> samples;
+
+    TimeSeriesRecorder(int windowSize) : window(windowSize) {}
+
+    void onStart(const vector<Process>& procs) override {
+        arrivalTimes.clear();
+        for (const auto &p : procs) arrivalTimes.push_back(p.at);
+        sort(arrivalTimes.begin(), arrivalTimes.end());
+        nextArrival = 0;
+        lastTime = 0;
+        queued = running = 0;
+        samples.clear();
+        openWindow(0);
+    }
+
+    void onDispatch(int time, const Process&) override {
+        advance(time);
+        queued--;
+        running = 1;
+        touchMax();
+    }
+
+    void onPreempt(int time, const Process&) override {
+        advance(time);
+        queued++;
+        running = 0;
+        touchMax();
+    }
+
+    void onComplete(int time, const Process&) override {
+        advance(time);
+        running = 0;
+        samples.back().completions++;
+    }
+
+    void onFinish(int time) override {
+        advance(time);
+        // Close the last (possibly partial) window over its covered length
+        // An empty window opened exactly at the end only holds the final
+        // completions; fold them into the window they finished
+        if (samples.size() > 1 && samples.back().start == time) {
+            WindowSample tail = samples.back();
+            samples.pop_back();
+            samples.back().arrivals += tail.arrivals;
+            samples.back().completions += tail.completions;
+        }
+        WindowSample &w = samples.back();
+        int covered = time - w.start;
+        if (covered >= window) return;   // Already closed by integrate()
+        w.avgQueue = covered > 0 ? queueArea / covered : 0;
+        w.utilization = covered > 0 ? (float)busy / covered : 0;
+    }
+
+    bool writeCSV(const string& path) const {
+        ofstream out(path);
+        if (!out) return false;
+        out << "start,avg_queue,max_queue,utilization,arrivals,completions\n";
+        out << fixed << setprecision(4);
+        for (const auto &w : samples) {
+            out << w.start << "," << w.avgQueue << "," << w.maxQueue << ","
+                << w.utilization << "," << w.arrivals << "," << w.completions << "\n";
+        }
+        return true;
+    }
+
+    // Binary layout: "TSR1", int32 window, uint64 count, then packed samples
+    bool writeBinary(const string& path) const {
+        ofstream out(path, ios::binary);
+        if (!out) return false;
+        unsigned long long count = samples.size();
+        out.write("TSR1", 4);
+        out.write((const char*)&window, sizeof(window));
+        out.write((const char*)&count, sizeof(count));
+        out.write((const char*)samples.data(), count * sizeof(WindowSample));
+        return (bool)out;
+    }
+
+private:
+    int window;
+    vector<int> arrivalTimes;
+    size_t nextArrival = 0;
+    int lastTime = 0;
+    int queued = 0, running = 0;
+    double queueArea = 0;   // Integral of queue length over the open window
+    long long busy = 0;     // Busy time within the open window
+
+    void openWindow(int start) {
+        samples.push_back({start, 0, queued, 0, 0, 0});
+        queueArea = 0;
+        busy = 0;
+    }
+
+    void touchMax() {
+        samples.back().maxQueue = max(samples.back().maxQueue, queued);
+    }
+
+    // Integrates the current state up to time t, letting arrivals land first
+    void advance(int t) {
+        while (nextArrival < arrivalTimes.size() && arrivalTimes[nextArrival] <= t) {
+            integrate(arrivalTimes[nextArrival]);
+            queued++;
+            samples.back().arrivals++;
+            touchMax();
+            nextArrival++;
+        }
+        integrate(t);
+    }
+
+    void integrate(int t) {
+        while (t > lastTime) {
+            int windowEnd = samples.back().start + window;
+            int upTo = min(t, windowEnd);
+            queueArea += (double)queued * (upTo - lastTime);
+            busy += (long long)running * (upTo - lastTime);
+            lastTime = upTo;
+            if (lastTime == windowEnd) {
+                samples.back().avgQueue = queueArea / window;
+                samples.back().utilization = (float)busy / window;
+                openWindow(windowEnd);
+            }
+        }
+    }
+};
+
+int fairnessCommand(const string& spec, const string& path) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    // Metrics only: the tracker sees every completion, so no Gantt chart is kept
+    size_t n = procs.size();
+    SimState st(algo, move(procs), quantum);
+    st.gantt.disable();
+    FairnessTracker fairness;
+    Schedule s = simulateState(st, &fairness);
+    cout << fixed << setprecision(2);
+    cout << s.algorithmName << ": " << n << " processes\n";
+    fairness.print();
+    return 0;
+}
+
+int seriesCommand(const string& spec, const string& path, int window, const string& outPath) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    if (window <= 0) {
+        cout << "Invalid window size.\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    TimeSeriesRecorder series(window);
+    Schedule s = runAlgorithm(algo, procs, quantum, &series);
+    printResults(s);
+
+    bool binary = outPath.size() > 4 && outPath.compare(outPath.size() - 4, 4, ".bin") == 0;
+    bool ok = binary ? series.writeBinary(outPath) : series.writeCSV(outPath);
+    if (!ok) {
+        cout << "Cannot write time series to " << outPath << "\n";
+        return 1;
+    }
+    cout << "Wrote " << series.samples.size() << " windows of " << window
+         << " units to " << outPath << "\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Linux Scheduler Trace Import (perf sched script / ftrace)
+// -----------------------------------------------------------------------------
+
+// Turns sched_wakeup / sched_switch events into workload rows. A job is one
+// run episode of a task: it arrives at the wakeup, accumulates CPU time across
+// any preemptions, and ends when the task switches out in a sleeping state.
+// Only tasks with an open episode are kept, so memory is bounded by the number
+// of concurrently runnable tasks rather than by the trace length.
+class SchedTraceImporter {
+public:
+    long long jobs = 0;
+    long long events = 0;
+    long long dropped = 0;                    // Never ran before the trace ended, or overflows int
+    double observedTAT = 0, observedWT = 0;   // Totals the kernel actually delivered
+
+    SchedTraceImporter(ostream& o, double unitsPerSecond) : out(o), scale(unitsPerSecond) {}
+
+    void feed(const string& line) {
+        size_t ev = line.find("sched_switch:");
+        bool isSwitch = ev != string::npos;
+        if (!isSwitch) ev = line.find("sched_wakeup");
+        if (ev == string::npos) return;
+        double ts;
+        if (!timestampBefore(line, ev, ts)) return;
+        if (!haveStart) {
+            start = ts;
+            haveStart = true;
+        }
+        lastTs = ts;
+        events++;
+
+        size_t body = line.find(':', ev) + 1;
+        if (isSwitch) handleSwitch(line, body, ts);
+        else handleWakeup(line, body, ts);
+    }
+
+    // Closes episodes still open at the end of the trace
+    void finish() {
+        for (auto &entry : active) {
+            Episode &e = entry.second;
+            if (e.running) e.runtime += lastTs - e.runStart;
+            if (e.runtime > 0) emit(e, lastTs);
+            else dropped++;   // Burst unknown: the task never got the CPU
+        }
+        active.clear();
+    }
+
+private:
+    struct Episode {
+        int pid = 0;
+        double wake = 0;
+        double runtime = 0;
+        double runStart = 0;
+        bool running = false;
+        int prio = 0;
+    };
+
+    ostream& out;
+    double scale;
+    double start = 0, lastTs = 0;
+    bool haveStart = false;
+    unordered_map<int, Episode> active;
+
+    // The timestamp is the "seconds.fraction:" token before the event name,
+    // which perf additionally prefixes with "sched:"
+    static bool timestampBefore(const string& line, size_t ev, double &ts) {
+        size_t p = ev;
+        if (p >= 6 && line.compare(p - 6, 6, "sched:") == 0) p -= 6;
+        while (p > 0 && line[p - 1] == ' ') p--;
+        if (p == 0 || line[p - 1] != ':') return false;
+        size_t end = --p;
+        while (p > 0 && (isdigit((unsigned char)line[p - 1]) || line[p - 1] == '.')) p--;
+        if (p == end) return false;
+        ts = strtod(line.c_str() + p, nullptr);
+        return true;
+    }
+
+    // Value of "key=" (preceded by a space) within [from, to)
+    static bool field(const string& line, size_t from, size_t to, const string& key, string &val) {
+        size_t k = line.find(" " + key + "=", from - 1);
+        if (k == string::npos || k >= to) return false;
+        size_t v = k + key.size() + 2;
+        size_t e = line.find(' ', v);
+        val = line.substr(v, min(e, to) - v);
+        return true;
+    }
+
+    // Compact perf form "comm:pid [prio] [STATE]" within [from, to)
+    static bool compactTask(const string& line, size_t from, size_t to, int &pid, int &prio, string &state) {
+        size_t br = line.find(" [", from);
+        if (br == string::npos || br >= to) return false;
+        size_t colon = line.rfind(':', br);
+        if (colon == string::npos || colon < from) return false;
+        pid = atoi(line.c_str() + colon + 1);
+        prio = atoi(line.c_str() + br + 2);
+        size_t st = line.find("] ", br);
+        state = st != string::npos && st + 2 < to ? line.substr(st + 2, line.find(' ', st + 2) - st - 2) : "";
+        return true;
+    }
+
+    void handleWakeup(const string& line, size_t body, double ts) {
+        int pid, prio;
+        string v, state;
+        if (field(line, body, line.size(), "pid", v)) {
+            pid = atoi(v.c_str());
+            prio = field(line, body, line.size(), "prio", v) ? atoi(v.c_str()) : 0;
+        } else if (!compactTask(line, body, line.size(), pid, prio, state)) {
+            return;
+        }
+        if (pid == 0 || active.count(pid)) return;   // Already runnable
+        Episode &e = active[pid];
+        e.pid = pid;
+        e.wake = ts;
+        e.prio = prio;
+    }
+
+    void handleSwitch(const string& line, size_t body, double ts) {
+        size_t arrow = line.find("==>", body);
+        if (arrow == string::npos) return;
+        int prevPid, prevPrio, nextPid, nextPrio;
+        string v, prevState, unused;
+        if (field(line, body, arrow, "prev_pid", v)) {
+            prevPid = atoi(v.c_str());
+            prevPrio = field(line, body, arrow, "prev_prio", v) ? atoi(v.c_str()) : 0;
+            if (field(line, body, arrow, "prev_state", v)) prevState = v;
+            nextPid = field(line, arrow, line.size(), "next_pid", v) ? atoi(v.c_str()) : 0;
+            nextPrio = field(line, arrow, line.size(), "next_prio", v) ? atoi(v.c_str()) : 0;
+        } else if (!compactTask(line, body, arrow, prevPid, prevPrio, prevState) ||
+                   !compactTask(line, arrow + 3, line.size(), nextPid, nextPrio, unused)) {
+            return;
+        }
+
+        auto it = active.find(prevPid);
+        if (prevPid != 0 && it != active.end() && it->second.running) {
+            Episode &e = it->second;
+            e.runtime += ts - e.runStart;
+            e.running = false;
+            // Still runnable ("R", "R+") means preempted; anything else blocked
+            if (prevState.empty() || prevState[0] != 'R') {
+                emit(e, ts);
+                active.erase(it);
+            }
+        }
+
+        if (nextPid != 0) {
+            // Tasks already running when the trace started arrive at first sight
+            auto in = active.find(nextPid);
+            if (in == active.end()) {
+                in = active.emplace(nextPid, Episode()).first;
+                in->second.pid = nextPid;
+                in->second.wake = ts;
+                in->second.prio = nextPrio;
+            }
+            in->second.running = true;
+            in->second.runStart = ts;
+        }
+    }
+
+    void emit(const Episode& e, double end) {
+        long long at = llround((e.wake - start) * scale);
+        long long bt = max(1LL, llround(e.runtime * scale));
+        if (at > INT_MAX || bt > INT_MAX) {
+            dropped++;
+            return;
+        }
+        double tat = (end - e.wake) * scale;
+        observedTAT += tat;
+        observedWT += max(0.0, tat - e.runtime * scale);
+        out << at << "," << bt << "," << max(0, e.prio) << "," << e.pid << "\n";
+        jobs++;
+    }
+};
+
+int importTraceCommand(const string& tracePath, const string& outPath, const string& unit) {
+    double scale = unit == "ns" ? 1e9 : unit == "ms" ? 1e3 : unit == "us" ? 1e6 : 0;
+    if (scale == 0) {
+        cout << "Unknown time unit: " << unit << " (use ns, us or ms)\n";
+        return 1;
+    }
+    ifstream in(tracePath);
+    if (!in) {
+        cout << "Cannot open trace file: " << tracePath << "\n";
+        return 1;
+    }
+    ofstream out(outPath);
+    if (!out) {
+        cout << "Cannot write workload to " << outPath << "\n";
+        return 1;
+    }
+
+    out << "at,bt,priority,task\n";
+    SchedTraceImporter importer(out, scale);
+    string line;
+    while (getline(in, line)) importer.feed(line);
+    importer.finish();
+
+    cout << fixed << setprecision(2);
+    cout << "Imported " << importer.jobs << " jobs from " << importer.events
+         << " scheduler events into " << outPath << " (time unit: " << unit << ")\n";
+    if (importer.dropped) {
+        cout << "Dropped " << importer.dropped << " jobs that never ran or exceed the int time range\n";
+    }
+    if (importer.jobs) {
+        cout << "Observed (kernel) Average Turn Around Time: " << importer.observedTAT / importer.jobs << " units\n";
+        cout << "Observed (kernel) Average Waiting Time: " << importer.observedWT / importer.jobs << " units\n";
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Calibration Against Real Threads
+// -----------------------------------------------------------------------------
+
+// Runs the workload as real threads under a Linux scheduling policy: each
+// thread sleeps until its AT and then burns BT units of its own CPU time
+// (1 unit = unitUs microseconds). Only the thread's CPU clock counts toward
+// the burst, so time spent preempted shows up as waiting, as in the model.
+struct CalibrationRun {
+    int policy;
+    vector<double> ct;       // Measured completion time per process, in units
+    vector<double> rt;       // Measured first-run delay per process, in units
+    bool policyApplied = true;
+};
+
+double monotonicUs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+double threadCpuUs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Parses a CPU list such as "0", "0,2" or "1-3"
+bool parseCpuList(const string& list, cpu_set_t &set) {
+    CPU_ZERO(&set);
+    stringstream ss(list);
+    string part;
+    while (getline(ss, part, ',')) {
+        size_t dash = part.find('-');
+        int lo = atoi(part.c_str());
+        int hi = dash == string::npos ? lo : atoi(part.c_str() + dash + 1);
+        if (part.empty() || lo < 0 || hi < lo || hi >= CPU_SETSIZE) return false;
+        for (int c = lo; c <= hi; c++) CPU_SET(c, &set);
+    }
+    return CPU_COUNT(&set) > 0;
+}
+
+CalibrationRun runCalibration(const vector<Process>& procs, int policy, double unitUs, const cpu_set_t& cpus) {
+    int n = procs.size();
+    CalibrationRun run;
+    run.policy = policy;
+    run.ct.assign(n, 0);
+    run.rt.assign(n, 0);
+    atomic<bool> applied{true};
+
+    // Leave time to create every thread before the first arrival
+    double epoch = monotonicUs() + 20000 + n * 50;
+    vector<thread> threads;
+    for (int i = 0; i < n; i++) {
+        threads.emplace_back([&, i]{
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            sched_param param;
+            param.sched_priority = policy == SCHED_OTHER ? 0 : 1;
+            if (pthread_setschedparam(pthread_self(), policy, &param) != 0) applied = false;
+
+            double release = epoch + procs[i].at * unitUs;
+            timespec ts;
+            ts.tv_sec = (time_t)(release / 1e6);
+            ts.tv_nsec = (long)((release - ts.tv_sec * 1e6) * 1e3);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+
+            double firstRun = monotonicUs();
+            double cpuStart = threadCpuUs();
+            double burst = procs[i].bt * unitUs;
+            while (threadCpuUs() - cpuStart < burst) {}
+            run.ct[i] = (monotonicUs() - epoch) / unitUs;
+            run.rt[i] = max(0.0, (firstRun - release) / unitUs);
+        });
+    }
+    for (auto &th : threads) th.join();
+    run.policyApplied = applied;
+    return run;
+}
+
+int calibrateCommand(const string& path, const string& policyName, double unitUs, const string& cpuList, string spec) {
+    int policy;
+    if (policyName == "other") policy = SCHED_OTHER;
+    else if (policyName == "fifo") policy = SCHED_FIFO;
+    else if (policyName == "rr") policy = SCHED_RR;
+    else {
+        cout << "Unknown policy: " << policyName << " (use other, fifo or rr)\n";
+        return 1;
+    }
+    cpu_set_t cpus;
+    if (unitUs <= 0 || !parseCpuList(cpuList, cpus)) {
+        cout << "Invalid time unit or CPU list.\n";
+        return 1;
+    }
+
+    // Closest simulated counterpart unless one is given: FIFO at equal
+    // priority is FCFS, SCHED_RR uses the kernel time slice, CFS is
+    // approximated by RR with a one-unit quantum
+    if (spec.empty()) {
+        if (policy == SCHED_FIFO) spec = "fcfs";
+        else if (policy == SCHED_RR) {
+            timespec slice = {0, 100000000};
+            sched_rr_get_interval(0, &slice);
+            int q = max(1, (int)llround((slice.tv_sec * 1e6 + slice.tv_nsec / 1e3) / unitUs));
+            spec = "rr:" + to_string(q);
+        } else spec = "rr:1";
+    }
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    Schedule sim = runAlgorithm(algo, procs, quantum);
+    sort(sim.procs.begin(), sim.procs.end(), [](const Process &a, const Process &b){
+        return a.pid < b.pid;
+    });
+    CalibrationRun real = runCalibration(procs, policy, unitUs, cpus);
+
+    cout << fixed << setprecision(2);
+    cout << "Calibration: SCHED_" << (policy == SCHED_FIFO ? "FIFO" : policy == SCHED_RR ? "RR" : "OTHER")
+         << " on " << CPU_COUNT(&cpus) << " CPU(s), 1 unit = " << unitUs << " us, vs " << sim.algorithmName << "\n";
+    if (!real.policyApplied) cout << "Warning: policy not permitted, threads ran under SCHED_OTHER\n";
+
+    cout << "\n\t\t\tSimulated\t\tMeasured\n";
+    cout << "PID\tAT\tBT\tCT\tTAT\tWT\tCT\tTAT\tWT\n";
+    cout << "------------------------------------------------------------------------\n";
+    double simTAT = 0, simWT = 0, simRT = 0, realTAT = 0, realWT = 0, realRT = 0, absErr = 0;
+    for (size_t i = 0; i < procs.size(); i++) {
+        const Process &p = sim.procs[i];
+        double ct = real.ct[p.pid - 1];
+        double tat = ct - p.at, wt = tat - p.bt;
+        simTAT += p.tat;
+        simWT += p.wt;
+        realTAT += tat;
+        realWT += wt;
+        simRT += p.rt;
+        realRT += real.rt[p.pid - 1];
+        absErr += fabs(ct - p.ct);
+        cout << p.pid << "\t" << p.at << "\t" << p.bt << "\t" << p.ct << "\t" << p.tat << "\t" << p.wt
+             << "\t" << ct << "\t" << tat << "\t" << wt << "\n";
+    }
+    size_t n = procs.size();
+    cout << "\nAverage TAT: simulated " << simTAT / n << ", measured " << realTAT / n << " units\n";
+    cout << "Average WT: simulated " << simWT / n << ", measured " << realWT / n << " units\n";
+    cout << "Average RT: simulated " << simRT / n << ", measured " << realRT / n << " units\n";
+    cout << "Mean |CT error|: " << absErr / n << " units\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Batch Runner (many independent workloads on a thread pool)
+// -----------------------------------------------------------------------------
+
+// One workload of a batch: either a file to load or inline CSV text taken
+// from a multi-workload file
+// Quotes a CSV field when it holds a comma, quote or line break
+string csvField(const string& s) {
+    if (s.find_first_of(",\"\r\n") == string::npos) return s;
+    string q = "\"";
+    for (char c : s) {
+        if (c == '"') q += '"';
+        q += c;
+    }
+    return q + "\"";
+}
+
+struct BatchTask {
+    string name;
+    string path;
+    string text;
+};
+
+struct WorkloadSummary {
+    bool ok = false;
+    string error;
+    int processes = 0;
+    double avgTAT = 0, avgWT = 0, avgRT = 0;
+    long long idle = 0, makespan = 0;
+    double jain = 1.0;
+};
+
+// Collects batch tasks from a directory of CSV files (sorted by name) or from
+// a multi-workload file where each workload starts with a "[name]" line
+bool collectBatchTasks(const string& source, vector<BatchTask> &tasks) {
+    error_code ec;
+    if (filesystem::is_directory(source, ec)) {
+        for (const auto &entry : filesystem::directory_iterator(source, ec)) {
+            if (entry.is_regular_file()) {
+                tasks.push_back({entry.path().filename().string(), entry.path().string(), ""});
+            }
+        }
+        sort(tasks.begin(), tasks.end(), [](const BatchTask &a, const BatchTask &b){
+            return a.name < b.name;
+        });
+        return !ec;
+    }
+
+    ifstream in(source);
+    if (!in) {
+        cout << "Cannot open batch source: " << source << "\n";
+        return false;
+    }
+    string line;
+    int at, bt, pri, task;
+    while (getline(in, line)) {
+        if (!line.empty() && line[0] == '[') {
+            size_t close = line.find(']');
+            tasks.push_back({line.substr(1, close == string::npos ? string::npos : close - 1), "", ""});
+        } else if (!tasks.empty()) {
+            tasks.back().text += line;
+            tasks.back().text += '\n';
+        } else if (parseWorkloadLine(line, at, bt, pri, task) != 0) {
+            cout << "Batch file rows must follow a [name] line\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Aggregate statistics for one batch worker. Each shard sits on its own cache
+// lines so workers never write to a shared line, and integer sums plus bucket
+// counts make the final merge exact however workloads were split.
+struct alignas(64) AggregateShard {
+    static const int WT_BUCKETS = 33;   // 0 for WT 0, then log2 buckets
+
+    long long workloads = 0, failed = 0, processes = 0;
+    long long sumTAT = 0, sumWT = 0, sumRT = 0, idle = 0;
+    long long maxMakespan = 0;
+    long long wtHist[WT_BUCKETS] = {};
+
+    void add(const Process& p) {
+        processes++;
+        sumTAT += p.tat;
+        sumWT += p.wt;
+        sumRT += p.rt;
+        wtHist[p.wt == 0 ? 0 : 1 + burstBucket(p.wt)]++;
+    }
+
+    void merge(const AggregateShard& o) {
+        workloads += o.workloads;
+        failed += o.failed;
+        processes += o.processes;
+        sumTAT += o.sumTAT;
+        sumWT += o.sumWT;
+        sumRT += o.sumRT;
+        idle += o.idle;
+        maxMakespan = max(maxMakespan, o.maxMakespan);
+        for (int b = 0; b < WT_BUCKETS; b++) wtHist[b] += o.wtHist[b];
+    }
+
+    void print() const {
+        cout << "\nBatch Aggregate (" << workloads << " workloads, " << processes << " processes):\n";
+        if (processes == 0) return;
+        cout << fixed << setprecision(2);
+        cout << "Average Turn Around Time: " << (double)sumTAT / processes << " units\n";
+        cout << "Average Waiting Time: " << (double)sumWT / processes << " units\n";
+        cout << "Average Response Time: " << (double)sumRT / processes << " units\n";
+        cout << "Total CPU Idle Time: " << idle << " units\n";
+        cout << "Longest Makespan: " << maxMakespan << " units\n";
+        cout << "\nWT\tPROCESSES\n";
+        for (int b = 0; b < WT_BUCKETS; b++) {
+            if (wtHist[b] == 0) continue;
+            if (b == 0) cout << "0";
+            else if (b == 1) cout << "1";
+            else cout << (1LL << (b - 1)) << "-" << (1LL << b) - 1;
+            cout << "\t" << wtHist[b] << "\n";
+        }
+    }
+};
+
+// Per-thread state kept across workloads: the worker loads each workload
+// straight into its own SimState and reruns the engine on it, so the state's
+// buffers are allocated once per thread. Runs are metrics-only (no Gantt
+// chart); on one CPU the idle time is the makespan minus the total burst.
+// Results stay in the worker's own shard until the pool has finished.
+struct BatchWorker {
+    AggregateShard shard;
+    vector<pair<size_t, WorkloadSummary>> results;
+    SimState st;
+    FairnessTracker fairness;
+
+    WorkloadSummary run(const BatchTask& task, const string& algo, int quantum) {
+        WorkloadSummary sum;
+        st.reset(algo, quantum);
+        st.gantt.disable();
+        bool loaded = false;
+        if (!task.path.empty()) {
+            ifstream in(task.path);
+            if (!in) sum.error = "cannot open file";
+            else loaded = readWorkload(in, st.procs, sum.error);
+        } else {
+            istringstream in(task.text);
+            loaded = readWorkload(in, st.procs, sum.error);
+        }
+        if (!loaded || st.procs.empty()) {
+            if (loaded) sum.error = "empty workload";
+            shard.failed++;
+            return sum;
+        }
+
+        Schedule s = simulateState(st, &fairness);
+        long long busy = 0;
+        for (const auto &p : s.procs) {
+            sum.avgTAT += p.tat;
+            sum.avgWT += p.wt;
+            sum.avgRT += p.rt;
+            busy += p.bt;
+            sum.makespan = max(sum.makespan, (long long)p.ct);
+            shard.add(p);
+        }
+        sum.idle = sum.makespan - busy;
+        sum.processes = s.procs.size();
+        sum.avgTAT /= sum.processes;
+        sum.avgWT /= sum.processes;
+        sum.avgRT /= sum.processes;
+        sum.jain = fairness.jainIndex();
+        sum.ok = true;
+        shard.workloads++;
+        shard.idle += sum.idle;
+        shard.maxMakespan = max(shard.maxMakespan, sum.makespan);
+        return sum;
+    }
+};
+
+// Work-stealing pool: each worker drains its own deque from the back and,
+// once empty, steals from the front of the other workers' deques
+class WorkStealingPool {
+public:
+    WorkStealingPool(int threads) : queues(threads) {}
+
+    void run(size_t taskCount, const function<void(int worker, size_t task)>& fn) {
+        int threads = queues.size();
+        for (size_t t = 0; t < taskCount; t++) queues[t % threads].tasks.push_back(t);
+
+        vector<thread> pool;
+        for (int w = 0; w < threads; w++) {
+            pool.emplace_back([this, w, &fn]{
+                size_t task;
+                while (next(w, task)) fn(w, task);
+            });
+        }
+        for (auto &th : pool) th.join();
+    }
+
+private:
+    struct WorkQueue {
+        mutex lock;
+        deque<size_t> tasks;
+    };
+    vector<WorkQueue> queues;
+
+    bool next(int w, size_t &task) {
+        {
+            lock_guard<mutex> guard(queues[w].lock);
+            if (!queues[w].tasks.empty()) {
+                task = queues[w].tasks.back();
+                queues[w].tasks.pop_back();
+                return true;
+            }
+        }
+        // Tasks are never added after start, so one empty sweep means done
+        for (size_t i = 1; i < queues.size(); i++) {
+            WorkQueue &victim = queues[(w + i) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+int batchCommand(const string& spec, const string& source, const string& outPath, int threads) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<BatchTask> tasks;
+    if (!collectBatchTasks(source, tasks)) return 1;
+    if (threads <= 0) threads = max(1u, thread::hardware_concurrency());
+
+    vector<BatchWorker> workers(threads);
+    WorkStealingPool pool(threads);
+    pool.run(tasks.size(), [&](int w, size_t t){
+        workers[w].results.emplace_back(t, workers[w].run(tasks[t], algo, quantum));
+    });
+
+    // Merge the worker shards once all threads have joined
+    vector<WorkloadSummary> results(tasks.size());
+    AggregateShard total;
+    for (auto &w : workers) {
+        for (auto &r : w.results) results[r.first] = move(r.second);
+        total.merge(w.shard);
+    }
+
+    ofstream out(outPath);
+    if (!out) {
+        cout << "Cannot write batch results to " << outPath << "\n";
+        return 1;
+    }
+    out << "workload,processes,avg_tat,avg_wt,avg_rt,idle,makespan,jain,status\n";
+    out << fixed << setprecision(4);
+    for (size_t t = 0; t < tasks.size(); t++) {
+        const WorkloadSummary &r = results[t];
+        out << csvField(tasks[t].name) << "," << r.processes << "," << r.avgTAT << "," << r.avgWT
+            << "," << r.avgRT << "," << r.idle << "," << r.makespan << "," << r.jain << ","
+            << (r.ok ? "ok" : csvField(r.error)) << "\n";
+    }
+
+    cout << "Simulated " << total.workloads << " of " << tasks.size()
+         << " workloads on " << threads << " threads, results in " << outPath << "\n";
+    total.print();
+    return total.failed ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Asynchronous Output Writer
+// -----------------------------------------------------------------------------
+
+// Background writer fed through a bounded single-producer/single-consumer
+// ring of rendered buffers. The simulation thread only renders text; the
+// writer thread does the actual I/O. When the ring is full, submit() waits,
+// so a slow disk throttles the producer instead of growing memory.
+class AsyncWriter {
+public:
+    AsyncWriter(FILE* out, size_t slots = 8) : file(out), ring(slots) {
+        worker = thread([this]{ drain(); });
+    }
+
+    ~AsyncWriter() { finish(); }
+
+    // Writes out everything submitted and stops the writer thread; false if
+    // any write or the final flush failed
+    bool finish() {
+        if (worker.joinable()) {
+            closed.store(true, memory_order_release);
+            dataReady.notify_one();
+            worker.join();
+            if (fflush(file) != 0) failed = true;
+        }
+        return !failed;
+    }
+
+    void submit(string &buf) {
+        size_t t = tail.load(memory_order_relaxed);
+        while (t - head.load(memory_order_acquire) == ring.size()) {
+            unique_lock<mutex> lock(waitLock);
+            spaceReady.wait_for(lock, chrono::milliseconds(1), [&]{
+                return t - head.load(memory_order_acquire) < ring.size();
+            });
+        }
+        ring[t % ring.size()].swap(buf);
+        tail.store(t + 1, memory_order_release);
+        dataReady.notify_one();
+    }
+
+private:
+    FILE* file;
+    vector<string> ring;
+    atomic<size_t> head{0};   // Next slot to write (consumer)
+    atomic<size_t> tail{0};   // Next slot to fill (producer)
+    atomic<bool> closed{false};
+    bool failed = false;      // Set by the writer thread, read after join()
+    mutex waitLock;           // Only used to sleep; the ring itself is lock-free
+    condition_variable dataReady, spaceReady;
+    thread worker;
+
+    void drain() {
+        for (;;) {
+            size_t h = head.load(memory_order_relaxed);
+            if (h == tail.load(memory_order_acquire)) {
+                if (closed.load(memory_order_acquire) && h == tail.load(memory_order_acquire)) return;
+                unique_lock<mutex> lock(waitLock);
+                dataReady.wait_for(lock, chrono::milliseconds(1), [&]{
+                    return h != tail.load(memory_order_acquire) || closed.load(memory_order_acquire);
+                });
+                continue;
+            }
+            string &buf = ring[h % ring.size()];
+            if (!failed && fwrite(buf.data(), 1, buf.size(), file) != buf.size()) failed = true;
+            buf.clear();
+            head.store(h + 1, memory_order_release);
+            spaceReady.notify_one();
+        }
+    }
+};
+
+// Stream buffer that collects output into fixed-size chunks and hands each
+// full chunk to an AsyncWriter, so printResults() can render into it as-is
+class AsyncOutputBuf : public streambuf {
+public:
+    AsyncOutputBuf(AsyncWriter& w, size_t size = 1 << 16) : writer(w), chunkSize(size) {
+        chunk.reserve(chunkSize);
+    }
+    ~AsyncOutputBuf() { sync(); }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof()) {
+            chunk.push_back((char)c);
+            if (chunk.size() >= chunkSize) flushChunk();
+        }
+        return c;
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        chunk.append(s, n);
+        if (chunk.size() >= chunkSize) flushChunk();
+        return n;
+    }
+
+    int sync() override {
+        if (!chunk.empty()) flushChunk();
+        return 0;
+    }
+
+private:
+    AsyncWriter& writer;
+    size_t chunkSize;
+    string chunk;
+
+    void flushChunk() {
+        writer.submit(chunk);   // Hands over the chunk and receives a recycled one
+        chunk.clear();
+        chunk.reserve(chunkSize);
+    }
+};
+
+// Simulates each algorithm in turn while the previous run's report is still
+// being written, so wall time approaches max(simulate, write)
+int runCommandAsync(const string& specs, const string& path, const string& outPath) {
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    vector<pair<string, int>> algos;
+    stringstream list(specs);
+    string spec;
+    while (getline(list, spec, ',')) {
+        string algo;
+        int quantum;
+        if (!parseAlgorithm(spec, algo, quantum)) {
+            cout << "Unknown algorithm: " << spec << "\n";
+            return 1;
+        }
+        algos.push_back({algo, quantum});
+    }
+
+    FILE* file = outPath.empty() ? stdout : fopen(outPath.c_str(), "w");
+    if (!file) {
+        cout << "Cannot write results to " << outPath << "\n";
+        return 1;
+    }
+    cout.flush();
+    bool ok;
+    {
+        AsyncWriter writer(file);
+        AsyncOutputBuf buf(writer);
+        ostream out(&buf);
+        for (const auto &a : algos) {
+            FairnessTracker fairness;
+            Schedule s = runAlgorithm(a.first, procs, a.second, &fairness);
+            printResults(s, out);
+            fairness.print(out);
+        }
+        out.flush();
+        ok = writer.finish();
+    }
+    if (file != stdout && fclose(file) != 0) ok = false;
+    if (!ok) {
+        cerr << "I/O error while writing " << (outPath.empty() ? "standard output" : outPath) << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+// Runs one algorithm with periodic checkpoints. With resumePath set the
+// state comes from that checkpoint and spec/path are ignored.
+int checkpointedRunCommand(const string& spec, const string& path, const string& resumePath,
+                           const string& ckptPath, double interval, const string& outPath) {
+    SimState st;
+    size_t committed = 0;
+    if (!resumePath.empty()) {
+        string error;
+        if (!loadCheckpoint(resumePath, st, committed, error)) {
+            cout << "Cannot read checkpoint " << resumePath << ": " << error << "\n";
+            return 1;
+        }
+    } else {
+        string algo;
+        int quantum;
+        if (!parseAlgorithm(spec, algo, quantum)) {
+            cout << "Unknown algorithm: " << spec << "\n";
+            return 1;
+        }
+        vector<Process> procs;
+        if (!loadWorkload(path, procs)) return 1;
+        if (procs.empty()) {
+            cout << "Workload is empty.\n";
+            return 1;
+        }
+        st = SimState(algo, move(procs), quantum);
+        // A fresh run must not pick up blocks from an older run's file
+        remove((ckptPath + ".gantt").c_str());
+    }
+
+    ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath);
+        if (!file) {
+            cout << "Cannot write results to " << outPath << "\n";
+            return 1;
+        }
+    }
+    ostream &out = outPath.empty() ? cout : file;
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    Checkpointer ckpt(ckptPath, interval, committed);
+    FairnessTracker fairness;
+    Schedule s = simulateState(st, &fairness, &ckpt);
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    printResults(s, out);
+    fairness.print(out);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// What-If Branching
+// -----------------------------------------------------------------------------
+
+// Builds the state for continuing a paused run under another algorithm. The
+// process table is copied, since every continuation rewrites it. The Gantt
+// prefix stays out of the simulation itself: continuations record only their
+// own blocks, and stitchFork copies the prefix in front of them for output.
+SimState branchFrom(const SimState &base, const string& algo, int quantum) {
+    SimState st(algo, base.procs, quantum);
+    st.started = true;
+    st.time = base.time;
+    for (const auto &p : st.procs) {
+        if (p.rem_bt == 0) st.completedCount++;
+    }
+
+    if (algo == "fcfs" || algo == "rr") {
+        // FCFS and RR walk processes in arrival order
+        stable_sort(st.procs.begin(), st.procs.end(), [](const Process &a, const Process &b){
+            return a.at < b.at;
+        });
+    }
+    if (algo == "sjf" || algo == "priority") {
+        st.completed.resize(st.procs.size());
+        for (size_t i = 0; i < st.procs.size(); i++) st.completed[i] = st.procs[i].rem_bt == 0;
+    }
+    if (algo == "rr" && base.algo == "rr") {
+        // Same arrival order, so the queue indices still apply
+        st.readyQueue = base.readyQueue;
+        st.inQueue = base.inQueue;
+        st.nextArrival = base.nextArrival;
+    } else if (algo == "rr") {
+        int n = st.procs.size();
+        st.inQueue.assign(n, false);
+        while (st.nextArrival < n && st.procs[st.nextArrival].at <= st.time) {
+            int i = st.nextArrival++;
+            if (st.procs[i].rem_bt > 0) {
+                st.readyQueue.push_back(i);
+                st.inQueue[i] = true;
+            }
+        }
+    }
+    return st;
+}
+
+// Joins a copy of the fork point's Gantt prefix with a continuation's blocks
+Schedule stitchFork(const SimState &base, Schedule tail) {
+    Schedule s{tail.algorithmName, move(tail.procs), base.gantt};
+    GanttChart::Cursor c = tail.gantt.at(0);
+    GanttChart::Segment seg;
+    while (c.next(seg)) s.gantt.push(seg.start, seg.pid);
+    s.gantt.finish(tail.gantt.empty() ? base.time : tail.gantt.endTime());
+    return s;
+}
+
+// Simulates `spec` up to time t, then finishes the run once per algorithm
+// in `branches`, in parallel, all starting from that one snapshot
+int whatIfCommand(const string& spec, const string& path, int t, const string& branches) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<pair<string, int>> algos;
+    stringstream list(branches);
+    string item;
+    while (getline(list, item, ',')) {
+        string a;
+        int q;
+        if (!parseAlgorithm(item, a, q)) {
+            cout << "Unknown algorithm: " << item << "\n";
+            return 1;
+        }
+        algos.push_back({a, q});
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    auto fork = make_shared<SimState>(algo, move(procs), quantum);
+    fork->pauseAt = t;
+    Schedule done = simulateState(*fork);
+    if (!done.algorithmName.empty()) fork->gantt = move(done.gantt); // Finished before t
+    fork->pauseAt = INT_MAX;
+
+    int threads = max(1, min((int)algos.size(), (int)thread::hardware_concurrency()));
+    cout << "Forked " << spec << " at t=" << fork->time << " with " << fork->completedCount
+         << " of " << fork->procs.size() << " processes complete; running "
+         << algos.size() << " continuation(s) on " << threads << " thread(s).\n";
+
+    shared_ptr<const SimState> snapshot = fork;
+    vector<string> reports(algos.size());
+    WorkStealingPool pool(threads);
+    pool.run(algos.size(), [&](int, size_t i){
+        SimState st = branchFrom(*snapshot, algos[i].first, algos[i].second);
+        FairnessTracker fairness;
+        Schedule s = stitchFork(*snapshot, simulateState(st, &fairness));
+        s.algorithmName += " (from t=" + to_string(snapshot->time) + ")";
+        stringstream out;
+        printResults(s, out);
+        fairness.print(out);
+        reports[i] = out.str();
+    });
+    for (const auto &r : reports) cout << r;
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Incremental Re-simulation
+// -----------------------------------------------------------------------------
+
+// FCFS completion times follow ct[i] = max(ct[i-1], at[i]) + bt[i] along the
+// arrival order. An edit therefore only touches the suffix from the first
+// position it moves, and the walk stops at the first later process whose
+// completion time comes out unchanged.
+class IncrementalFCFS {
+public:
+    explicit IncrementalFCFS(const vector<Process>& input) : procs(input) {
+        for (size_t i = 0; i < procs.size(); i++) order.push_back(i);
+        stable_sort(order.begin(), order.end(), [&](int a, int b){
+            return procs[a].at < procs[b].at;
+        });
+        recompute(0, 0);
+    }
+
+    // Sets the process with this pid (pid == count() + 1 adds one) and
+    // returns how many completion times were recomputed
+    size_t update(int pid, int at, int bt, int pri) {
+        size_t oldPos = order.size();
+        if (pid > (int)procs.size()) {
+            procs.push_back(Process(pid, at, bt, pri));
+        } else {
+            oldPos = position(pid - 1);
+            order.erase(order.begin() + oldPos);
+            forget(procs[pid - 1]);
+            procs[pid - 1] = Process(pid, at, bt, pri, procs[pid - 1].task);
+        }
+        size_t newPos = position(pid - 1);
+        order.insert(order.begin() + newPos, pid - 1);
+        if (oldPos == order.size()) oldPos = newPos; // Added
+        return recompute(min(oldPos, newPos), max(oldPos, newPos));
+    }
+
+    size_t count() const { return procs.size(); }
+    double avgTAT() const { return (double)sumTAT / procs.size(); }
+    double avgWT() const { return (double)sumWT / procs.size(); }
+    int makespan() const { return procs[order.back()].ct; }
+
+    Schedule schedule() const {
+        Schedule s{"FCFS", procs, {}};
+        int time = 0;
+        for (int i : order) {
+            const Process &p = procs[i];
+            if (p.at > time) s.gantt.push(time, 0);
+            s.gantt.push(max(time, p.at), p.pid);
+            time = p.ct;
+        }
+        s.gantt.finish(time);
+        return s;
+    }
+
+private:
+    vector<Process> procs;   // Indexed by pid - 1
+    vector<int> order;       // Arrival order, ties by pid
+    long long sumTAT = 0, sumWT = 0;
+
+    // Slot of procs[i] in order (or where it belongs, if not in it)
+    size_t position(int i) const {
+        auto before = [&](int a, int b){
+            return procs[a].at != procs[b].at ? procs[a].at < procs[b].at : a < b;
+        };
+        return lower_bound(order.begin(), order.end(), i, before) - order.begin();
+    }
+
+    void forget(const Process &p) {
+        sumTAT -= p.tat;
+        sumWT -= p.wt;
+    }
+
+    // Recomputes from position `from`; positions after `last` hold the same
+    // processes as before the edit, so one unchanged ct there ends the walk
+    size_t recompute(size_t from, size_t last) {
+        int time = from > 0 ? procs[order[from - 1]].ct : 0;
+        size_t i = from;
+        for (; i < order.size(); i++) {
+            Process &p = procs[order[i]];
+            int ct = max(time, p.at) + p.bt;
+            if (i > last && ct == p.ct) break;
+            if (p.ct > 0) forget(p);
+            p.rt = max(time, p.at) - p.at;
+            p.ct = ct;
+            p.tat = ct - p.at;
+            p.wt = p.tat - p.bt;
+            sumTAT += p.tat;
+            sumWT += p.wt;
+            time = ct;
+        }
+        return i - from;
+    }
+};
+
+// Other engines resume from the latest saved state that precedes the edited
+// arrival. States are saved at arrival-time quantiles of the workload; the
+// result's chart is spliced at the resume time.
+//
+// Saved states are sparse: a snapshot keeps the engine's scalars and RR queue
+// plus the progress of processes that may have changed since the previous
+// snapshot (arrived, and not finished by then). A state is rebuilt from the
+// current workload by applying the snapshots up to it in order, so memory
+// grows with arrivals plus the processes active at each mark. An overloaded
+// run can keep most processes active, so all snapshots together are capped
+// at SNAPSHOT_BUDGET entries per process: past it, neighbouring snapshots are
+// merged pairwise, which drops the earlier one as a resume point.
+class IncrementalRun {
+public:
+    IncrementalRun(const string& a, const vector<Process>& input, int q)
+        : algo(a), quantum(q), procs(input) {
+        vector<int> arrivals;
+        for (const auto &p : procs) arrivals.push_back(p.at);
+        sort(arrivals.begin(), arrivals.end());
+        for (int k = 1; k < MARKS; k++) {
+            int t = arrivals[arrivals.size() * k / MARKS];
+            if (t > 0 && (marks.empty() || t > marks.back())) marks.push_back(t);
+        }
+        runFrom(SimState(algo, procs, quantum));
+    }
+
+    // Sets the process with this pid (pid == count() + 1 adds one) and
+    // returns the time the simulation resumed from
+    int update(int pid, int at, int bt, int pri) {
+        bool added = pid > (int)procs.size();
+        int changed = added ? at : min(at, procs[pid - 1].at);
+        if (added) procs.push_back(Process(pid, at, bt, pri));
+        else procs[pid - 1] = Process(pid, at, bt, pri, procs[pid - 1].task);
+
+        // Saved states at or after the change are stale
+        while (!saved.empty() && saved.back().st.time >= changed) {
+            savedEntries -= saved.back().entries();
+            saved.pop_back();
+        }
+        if (saved.empty()) {
+            result = Schedule();
+            runFrom(SimState(algo, procs, quantum));
+            return 0;
+        }
+        SimState st = restore();
+        int from = st.time;
+        runFrom(move(st));
+        return from;
+    }
+
+    size_t count() const { return procs.size(); }
+    const Schedule& schedule() const { return result; }
+
+private:
+    static const int MARKS = 64;
+    static const int SNAPSHOT_BUDGET = 4;
+    string algo;
+    int quantum;
+    vector<Process> procs;   // Current workload, indexed by pid - 1
+    vector<int> marks;       // Times to save states at
+    Schedule result;
+
+    // Per-process fields an engine changes while it runs
+    struct Progress {
+        int pid, rem_bt, ct, tat, wt, rt, predicted;
+    };
+    struct Snapshot {
+        SimState st;                // Without procs, completed, inQueue or Gantt chart
+        vector<Progress> changed;
+
+        size_t entries() const { return changed.size() + st.readyQueue.size(); }
+    };
+    vector<Snapshot> saved;         // In increasing time
+    size_t savedEntries = 0;
+
+    void save(SimState &st) {
+        Snapshot snap;
+        int prev = saved.empty() ? INT_MIN : saved.back().st.time;
+        for (const auto &p : st.procs) {
+            // Finished by the previous snapshot means recorded there already
+            if (p.at <= st.time && !(p.ct > 0 && p.ct <= prev))
+                snap.changed.push_back({p.pid, p.rem_bt, p.ct, p.tat, p.wt, p.rt, p.predicted});
+        }
+        size_t budget = SNAPSHOT_BUDGET * st.procs.size();
+        while (savedEntries + snap.entries() + st.readyQueue.size() > budget && saved.size() > 1) thin();
+        if (savedEntries + snap.entries() + st.readyQueue.size() > budget) return;
+        vector<Process> procs;
+        vector<char> completed, inQueue;
+        GanttChart gantt;
+        swap(procs, st.procs);
+        swap(completed, st.completed);
+        swap(inQueue, st.inQueue);
+        swap(gantt, st.gantt);
+        snap.st = st;
+        swap(procs, st.procs);
+        swap(completed, st.completed);
+        swap(inQueue, st.inQueue);
+        swap(gantt, st.gantt);
+        savedEntries += snap.entries();
+        saved.push_back(move(snap));
+    }
+
+    // Merges each even-numbered snapshot into the one after it. The merged
+    // snapshot holds the later one's entries plus the earlier one's for
+    // processes the later one does not mention.
+    void thin() {
+        vector<char> seen(procs.size() + 1, false);
+        vector<Snapshot> kept;
+        savedEntries = 0;
+        for (size_t i = 0; i < saved.size(); i++) {
+            if (i % 2 == 0 && i + 1 < saved.size()) {
+                Snapshot &next = saved[i + 1];
+                for (const auto &c : next.changed) seen[c.pid] = true;
+                for (const auto &c : saved[i].changed) {
+                    if (!seen[c.pid]) next.changed.push_back(c);
+                }
+                for (const auto &c : next.changed) seen[c.pid] = false;
+                continue;
+            }
+            savedEntries += saved[i].entries();
+            kept.push_back(move(saved[i]));
+        }
+        saved = move(kept);
+    }
+
+    // State of the last snapshot over the current workload. Processes that
+    // had not arrived by then may have been edited or added since, and are
+    // taken from the workload as they are now.
+    SimState restore() const {
+        SimState st = saved.back().st;
+        st.procs = procs;
+        for (const auto &snap : saved) {
+            for (const auto &c : snap.changed) {
+                Process &p = st.procs[c.pid - 1];
+                p.rem_bt = c.rem_bt;
+                p.ct = c.ct;
+                p.tat = c.tat;
+                p.wt = c.wt;
+                p.rt = c.rt;
+                p.predicted = c.predicted;
+            }
+        }
+        int n = st.procs.size();
+        if (algo == "sjf" || algo == "priority") {
+            st.completed.assign(n, false);
+            for (int i = 0; i < n; i++) st.completed[i] = st.procs[i].rem_bt == 0;
+        }
+        if (algo == "rr") {
+            // The engine's arrival order; queued processes all precede nextArrival
+            stable_sort(st.procs.begin(), st.procs.end(), [](const Process &a, const Process &b){
+                return a.at < b.at;
+            });
+            st.inQueue.assign(n, false);
+            for (int i : st.readyQueue) st.inQueue[i] = true;
+        }
+        return st;
+    }
+
+    void runFrom(SimState st) {
+        int from = st.time;
+        st.lastBlock = ""; // The new chart starts with a fresh block
+        size_t m = upper_bound(marks.begin(), marks.end(), from) - marks.begin();
+        Schedule tail;
+        while (true) {
+            st.pauseAt = m < marks.size() ? marks[m++] : INT_MAX;
+            tail = simulateState(st);
+            if (!tail.algorithmName.empty()) break;
+            save(st);
+        }
+
+        // Keep the old chart up to `from`, then append the new blocks
+        Schedule s{tail.algorithmName, move(tail.procs), {}};
+        GanttChart::Cursor c = result.gantt.at(0);
+        GanttChart::Segment seg;
+        while (c.next(seg) && seg.start < from) s.gantt.push(seg.start, seg.pid);
+        c = tail.gantt.at(0);
+        while (c.next(seg)) s.gantt.push(seg.start, seg.pid);
+        s.gantt.finish(tail.gantt.empty() ? from : tail.gantt.endTime());
+        result = move(s);
+    }
+};
+
+// Reads edits from stdin and re-simulates incrementally after each one:
+//   set <pid> <at> <bt> [pri]   add <at> <bt> [pri]   show   quit
+int planCommand(const string& spec, const string& path) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    unique_ptr<IncrementalFCFS> fcfs;
+    unique_ptr<IncrementalRun> run;
+    if (algo == "fcfs") fcfs.reset(new IncrementalFCFS(procs));
+    else run.reset(new IncrementalRun(algo, procs, quantum));
+    cout << "Loaded " << procs.size() << " processes. Commands: set <pid> <at> <bt> [pri], "
+         << "add <at> <bt> [pri], show, quit\n";
+
+    string line;
+    while (getline(cin, line)) {
+        stringstream in(line);
+        string op;
+        if (!(in >> op)) continue;
+        if (op == "quit") break;
+        if (op == "show") {
+            Schedule s = fcfs ? fcfs->schedule() : run->schedule();
+            printResults(s);
+            continue;
+        }
+
+        int n = procs.size();
+        int pid = n + 1, at = -1, bt = 0, pri = 0;
+        bool ok = op == "add" || (op == "set" && in >> pid && pid >= 1 && pid <= n);
+        ok = ok && in >> at >> bt;
+        if (ok && pid <= n) pri = procs[pid - 1].priority; // Kept unless given
+        if (ok && !(in >> pri)) pri = pid <= n ? procs[pid - 1].priority : 0;
+        if (!ok || at < 0 || bt <= 0 || pri < 0) {
+            cout << "Invalid edit: " << line << "\n";
+            continue;
+        }
+        if (pid > n) procs.push_back(Process(pid, at, bt, pri));
+        else procs[pid - 1] = Process(pid, at, bt, pri, procs[pid - 1].task);
+
+        auto start = chrono::steady_clock::now();
+        string detail;
+        double avgTAT = 0, avgWT = 0;
+        int makespan = 0;
+        if (fcfs) {
+            detail = "recomputed " + to_string(fcfs->update(pid, at, bt, pri)) + " of " + to_string(n + (pid > n));
+            avgTAT = fcfs->avgTAT();
+            avgWT = fcfs->avgWT();
+            makespan = fcfs->makespan();
+        } else {
+            detail = "resumed from t=" + to_string(run->update(pid, at, bt, pri));
+            const Schedule &s = run->schedule();
+            long long tat = 0, wt = 0;
+            for (const auto &p : s.procs) {
+                tat += p.tat;
+                wt += p.wt;
+                makespan = max(makespan, p.ct);
+            }
+            avgTAT = (double)tat / s.procs.size();
+            avgWT = (double)wt / s.procs.size();
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << fixed << setprecision(2) << "P" << pid << " " << (pid > n ? "added" : "updated")
+             << " (" << detail << ", " << ms << " ms): avg TAT " << avgTAT
+             << ", avg WT " << avgWT << ", makespan " << makespan << "\n";
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Event Log (record / replay)
+// -----------------------------------------------------------------------------
+
+enum EventType { EV_ARRIVAL = 0, EV_DISPATCH = 1, EV_PREEMPT = 2, EV_COMPLETE = 3 };
+
+// Observer that records every scheduling decision. Each event is one varint
+// holding (time delta << 2 | type) followed by the pid; arrivals also carry
+// the priority. Arrivals are merged in from the sorted arrival times, as in
+// TimeSeriesRecorder. Encoded chunks go to disk through an AsyncWriter ring,
+// so the engine thread never blocks on I/O while the ring has room.
+//
+// File: "SIMEVLG1", varint process count, events, then an arrival of pid 0
+// marking the finish time, followed by the length-prefixed algorithm name.
+class EventLogger : public SimObserver {
+public:
+    EventLogger(AsyncWriter& w, size_t size = 1 << 16) : writer(w), chunkSize(size) {
+        chunk.reserve(chunkSize + 32);
+    }
+
+    void onStart(const vector<Process>& procs) override {
+        arrivals.clear();
+        for (const auto &p : procs) arrivals.push_back(&p);
+        stable_sort(arrivals.begin(), arrivals.end(), [](const Process* a, const Process* b){
+            return a->at != b->at ? a->at < b->at : a->pid < b->pid;
+        });
+        nextArrival = 0;
+        lastTime = 0;
+        chunk.append("SIMEVLG1", 8);
+        putVarint(chunk, procs.size());
+    }
+
+    void onDispatch(int time, const Process& p) override { event(time, EV_DISPATCH, p.pid); }
+    void onPreempt(int time, const Process& p) override { event(time, EV_PREEMPT, p.pid); }
+    void onComplete(int time, const Process& p) override { event(time, EV_COMPLETE, p.pid); }
+
+    void onFinish(int time) override {
+        event(time, EV_ARRIVAL, 0);
+        putVarint(chunk, 0);
+    }
+
+    // Appends the trailer and hands the last chunk to the writer
+    void close(const string& algorithmName) {
+        putVarint(chunk, algorithmName.size());
+        chunk += algorithmName;
+        bytes += chunk.size();
+        writer.submit(chunk);
+    }
+
+    long long events = 0;
+    unsigned long long bytes = 0;
+
+private:
+    AsyncWriter& writer;
+    size_t chunkSize;
+    string chunk;
+    vector<const Process*> arrivals;
+    size_t nextArrival = 0;
+    int lastTime = 0;
+
+    void put(int time, int type, int pid) {
+        putVarint(chunk, ((unsigned long long)(time - lastTime) << 2) | type);
+        putVarint(chunk, pid);
+        lastTime = time;
+        events++;
+    }
+
+    void event(int time, int type, int pid) {
+        while (nextArrival < arrivals.size() && arrivals[nextArrival]->at <= time) {
+            const Process* a = arrivals[nextArrival++];
+            put(a->at, EV_ARRIVAL, a->pid);
+            putVarint(chunk, a->priority);
+        }
+        put(time, type, pid);
+        if (chunk.size() >= chunkSize) {
+            bytes += chunk.size();
+            writer.submit(chunk);
+        }
+    }
+};
+
+// Rebuilds a run from an event log alone: process table, Gantt chart and
+// metrics, plus the original observer callbacks for obs. Bursts are the
+// summed dispatch-to-preempt/complete intervals; idle gaps are the time
+// between one process leaving the CPU and the next dispatch.
+bool replayEventLog(const string& data, Schedule &s, string &error, SimObserver* obs = nullptr) {
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    if (data.size() < 8 || memcmp(begin, "SIMEVLG1", 8) != 0) {
+        error = "not an event log";
+        return false;
+    }
+
+    struct Event { int time, type, pid, priority; };
+    const char* p = begin + 8;
+    unsigned long long count = 0, v = 0;
+    // Every process logs at least an arrival of three bytes or more, so a
+    // count the log cannot hold is corrupt; reject it before allocating
+    if (!getVarint(p, end, count) || count > INT_MAX || count > (unsigned long long)(end - p) / 3) {
+        error = "bad header";
+        return false;
+    }
+    const char* eventsStart = p;
+    long long time = 0;
+    // Decodes the event at p; returns false at the finish marker or on error
+    auto next = [&](Event &e) {
+        unsigned long long pid = 0, pri = 0;
+        if (!getVarint(p, end, v) || !getVarint(p, end, pid)) {
+            error = "truncated log";
+            return false;
+        }
+        time += v >> 2;
+        e = {(int)time, (int)(v & 3), (int)pid, 0};
+        if (time > INT_MAX || pid > count) {
+            error = "corrupt event at byte " + to_string(p - begin);
+            return false;
+        }
+        if (e.type == EV_ARRIVAL && !getVarint(p, end, pri)) {
+            error = "truncated log";
+            return false;
+        }
+        e.priority = pri;
+        return !(e.type == EV_ARRIVAL && pid == 0);
+    };
+
+    // Pass 1: process table
+    s = Schedule();
+    s.procs.clear();
+    for (size_t i = 1; i <= count; i++) s.procs.push_back(Process(i, 0, 0, 0));
+    vector<int> runningSince(count + 1, -1);
+    vector<char> arrived(count + 1, false);
+    int lastEnd = 0;   // Last time a process left the CPU
+    Event e;
+    while (next(e)) {
+        if (e.pid == 0) {
+            error = "event without a process at t=" + to_string(e.time);
+            return false;
+        }
+        if (e.type != EV_ARRIVAL && e.time < lastEnd) {
+            error = "event before the CPU was free at t=" + to_string(e.time);
+            return false;
+        }
+        Process &q = s.procs[e.pid - 1];
+        if (e.type == EV_ARRIVAL) {
+            q.at = e.time;
+            q.priority = e.priority;
+            arrived[e.pid] = true;
+        } else if (e.type == EV_DISPATCH) {
+            if (q.rt < 0) q.rt = e.time - q.at;
+            runningSince[e.pid] = e.time;
+        } else if (runningSince[e.pid] < 0) {
+            error = "P" + to_string(e.pid) + " leaves the CPU without running at t=" + to_string(e.time);
+            return false;
+        } else {
+            lastEnd = e.time;
+            q.bt += e.time - runningSince[e.pid];
+            runningSince[e.pid] = -1;
+            if (e.type == EV_COMPLETE) {
+                q.ct = e.time;
+                q.tat = q.ct - q.at;
+                q.wt = q.tat - q.bt;
+            }
+        }
+    }
+    if (!error.empty()) return false;
+    // Every process must arrive, run and complete, or its metrics (and the
+    // burst classes printResults() derives from bt) are meaningless
+    for (const auto &q : s.procs) {
+        if (!arrived[q.pid] || q.ct == 0 || q.bt <= 0) {
+            error = "P" + to_string(q.pid) + (arrived[q.pid] ? " never runs to completion" : " never arrives");
+            return false;
+        }
+    }
+    int finish = e.time;
+    unsigned long long nameLen = 0;
+    if (!getVarint(p, end, nameLen) || nameLen > (unsigned long long)(end - p)) {
+        error = "missing trailer";
+        return false;
+    }
+    s.algorithmName.assign(p, nameLen);
+    for (auto &q : s.procs) q.rem_bt = 0;
+
+    // Pass 2: Gantt chart and observer callbacks in the recorded order
+    if (obs) obs->onStart(s.procs);
+    p = eventsStart;
+    time = 0;
+    lastEnd = 0;
+    while (next(e)) {
+        const Process &q = s.procs[e.pid - 1];
+        if (e.type == EV_DISPATCH) {
+            if (obs) obs->onDispatch(e.time, q);
+            if (e.time > lastEnd) s.gantt.push(lastEnd, 0);
+            s.gantt.push(e.time, e.pid);
+        } else if (e.type != EV_ARRIVAL) {
+            if (obs && e.type == EV_PREEMPT) obs->onPreempt(e.time, q);
+            if (obs && e.type == EV_COMPLETE) obs->onComplete(e.time, q);
+            lastEnd = e.time;
+        }
+    }
+    s.gantt.finish(lastEnd);
+    if (obs) obs->onFinish(finish);
+    return true;
+}
+
+int recordCommand(const string& spec, const string& path, const string& logPath) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+    FILE* file = fopen(logPath.c_str(), "wb");
+    if (!file) {
+        cout << "Cannot write event log to " << logPath << "\n";
+        return 1;
+    }
+
+    auto started = chrono::steady_clock::now();
+    long long events;
+    unsigned long long bytes;
+    {
+        AsyncWriter writer(file);
+        EventLogger logger(writer);
+        Schedule s = runAlgorithm(algo, procs, quantum, &logger);
+        logger.close(s.algorithmName);
+        events = logger.events;
+        bytes = logger.bytes;
+    }
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    if (!ok) {
+        cout << "I/O error while writing " << logPath << "\n";
+        return 1;
+    }
+    cout << fixed << setprecision(2);
+    cout << "Recorded " << events << " events (" << bytes / 1024.0 << " KiB, "
+         << (events ? (double)bytes / events : 0) << " bytes/event) in " << secs * 1000 << " ms\n";
+    return 0;
+}
+
+int replayCommand(const string& logPath) {
+    ifstream in(logPath, ios::binary);
+    if (!in) {
+        cout << "Cannot read " << logPath << "\n";
+        return 1;
+    }
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    Schedule s;
+    string error;
+    FairnessTracker fairness;
+    if (!replayEventLog(data, s, error, &fairness)) {
+        cout << logPath << ": " << error << "\n";
+        return 1;
+    }
+    printResults(s);
+    fairness.print();
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Event Queues
+// -----------------------------------------------------------------------------
+
+// Pending simulation event: an arrival, completion or timer. Events with equal
+// times leave a queue in insertion order, so seq breaks ties and every backend
+// produces the same sequence.
+struct SimEvent {
+    long long time;
+    unsigned long long seq;
+    int pid;
+    int type;   // EventType
+
+    bool operator<(const SimEvent& o) const {
+        return time != o.time ? time < o.time : seq < o.seq;
+    }
+};
+
+// Backends below share push(e) / pop() / empty() / size() and are picked at
+// compile time as a template argument, or at run time by name (benchq). As in
+// any discrete-event simulation, no event may be pushed earlier than the last
+// one popped; the calendar and ladder queues rely on it.
+
+// Implicit D-ary min-heap. D = 4 halves the depth of a binary heap and keeps
+// each node's children within one cache line.
+template <int D>
+class DaryHeap {
+public:
+    void push(const SimEvent& e) {
+        size_t i = heap.size();
+        heap.push_back(e);
+        while (i > 0) {
+            size_t parent = (i - 1) / D;
+            if (!(e < heap[parent])) break;
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = e;
+    }
+
+    SimEvent pop() {
+        SimEvent top = heap[0];
+        SimEvent last = heap.back();
+        heap.pop_back();
+        size_t n = heap.size();
+        if (n == 0) return top;
+        size_t i = 0;
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= n) break;
+            size_t best = first;
+            for (size_t c = first + 1; c < min(first + D, n); c++) {
+                if (heap[c] < heap[best]) best = c;
+            }
+            if (!(heap[best] < last)) break;
+            heap[i] = heap[best];
+            i = best;
+        }
+        heap[i] = last;
+        return top;
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+private:
+    vector<SimEvent> heap;
+};
+
+// Pairing heap with nodes in a pool: O(1) push, amortized O(log n) pop using
+// the standard two-pass merge of the root's children.
+class PairingHeap {
+public:
+    void push(const SimEvent& e) {
+        int node;
+        if (!freeNodes.empty()) {
+            node = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            node = nodes.size();
+            nodes.emplace_back();
+        }
+        nodes[node] = {e, -1, -1};
+        root = root < 0 ? node : meld(root, node);
+        count++;
+    }
+
+    SimEvent pop() {
+        SimEvent top = nodes[root].e;
+        children.clear();
+        for (int c = nodes[root].child; c >= 0; ) {
+            int next = nodes[c].sibling;
+            nodes[c].sibling = -1;
+            children.push_back(c);
+            c = next;
+        }
+        freeNodes.push_back(root);
+        count--;
+
+        // Pass 1: meld pairs left to right; pass 2: fold right to left
+        size_t k = 0;
+        for (size_t i = 0; i + 1 < children.size(); i += 2) {
+            children[k++] = meld(children[i], children[i + 1]);
+        }
+        if (children.size() % 2) children[k++] = children.back();
+        root = -1;
+        while (k > 0) {
+            int t = children[--k];
+            root = root < 0 ? t : meld(t, root);
+        }
+        return top;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    struct Node {
+        SimEvent e;
+        int child, sibling;
+    };
+    vector<Node> nodes;
+    vector<int> freeNodes, children;
+    int root = -1;
+    size_t count = 0;
+
+    // Links the later root under the earlier one
+    int meld(int a, int b) {
+        if (nodes[b].e < nodes[a].e) swap(a, b);
+        nodes[b].sibling = nodes[a].child;
+        nodes[a].child = b;
+        return a;
+    }
+};
+
+// Calendar queue (Brown, 1988): a ring of day buckets of a fixed width, each
+// kept sorted. New events are usually the latest in their bucket, so buckets
+// are sorted earliest first and consumed from a head index. Dequeue walks
+// the days of the current year; the bucket count doubles or halves with the
+// size, and the width is re-estimated from the spacing of the earliest
+// events on every resize.
+class CalendarQueue {
+public:
+    CalendarQueue() { buckets.resize(MIN_BUCKETS); }
+
+    void push(const SimEvent& e) {
+        insert(e);
+        count++;
+        if (count > 2 * buckets.size()) resize(buckets.size() * 2);
+    }
+
+    SimEvent pop() {
+        while (true) {
+            // Scan one year from the current day
+            for (size_t n = 0; n < buckets.size(); n++) {
+                Bucket &b = buckets[current];
+                if (b.head < b.events.size() && b.events[b.head].time < dayEnd) {
+                    SimEvent e = b.events[b.head++];
+                    if (b.head == b.events.size()) {
+                        b.events.clear();
+                        b.head = 0;
+                    }
+                    lastTime = e.time;
+                    count--;
+                    if (count < buckets.size() / 2 && buckets.size() > MIN_BUCKETS) resize(buckets.size() / 2);
+                    return e;
+                }
+                current = (current + 1) % buckets.size();
+                dayEnd += width;
+            }
+            // Nothing this year, so the width no longer fits the spacing of
+            // events: re-estimate it and jump straight to the earliest event
+            resize(buckets.size());
+            long long earliest = LLONG_MAX;
+            for (const auto &b : buckets) {
+                if (b.head < b.events.size()) earliest = min(earliest, b.events[b.head].time);
+            }
+            moveTo(earliest);
+        }
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    static const size_t MIN_BUCKETS = 16;
+    struct Bucket {
+        vector<SimEvent> events;   // Sorted; those before head are already gone
+        size_t head = 0;
+    };
+    vector<Bucket> buckets;
+    long long width = 1;
+    size_t current = 0;
+    long long dayEnd = 1;               // End of the current day
+    long long lastTime = 0;
+    size_t count = 0;
+
+    void insert(const SimEvent& e) {
+        Bucket &b = buckets[(e.time / width) % buckets.size()];
+        b.events.insert(upper_bound(b.events.begin() + b.head, b.events.end(), e), e);
+    }
+
+    void moveTo(long long t) {
+        current = (t / width) % buckets.size();
+        dayEnd = (t / width + 1) * width;
+    }
+
+    void resize(size_t n) {
+        vector<SimEvent> all;
+        all.reserve(count);
+        for (auto &b : buckets) {
+            all.insert(all.end(), b.events.begin() + b.head, b.events.end());
+        }
+
+        // Average gap between the earliest few events, ignoring outliers
+        size_t sample = min<size_t>(all.size(), 25);
+        partial_sort(all.begin(), all.begin() + sample, all.end());
+        double gap = sample > 1 ? (double)(all[sample - 1].time - all[0].time) / (sample - 1) : 0;
+        double sum = 0;
+        int used = 0;
+        for (size_t i = 1; i < sample; i++) {
+            long long d = all[i].time - all[i - 1].time;
+            if (d <= 2 * gap) {
+                sum += d;
+                used++;
+            }
+        }
+        width = max(1LL, (long long)(3 * (used ? sum / used : gap)));
+
+        buckets.assign(n, {});
+        for (const auto &e : all) insert(e);
+        moveTo(lastTime);
+    }
+};
+
+// Ladder queue (Tang, Goh and Thng, 2005). Far-future events sit unsorted in
+// Top. When Bottom runs dry, Top is spread over a rung of buckets; a bucket
+// holding more than THRESHOLD events is spread over a finer child rung, and a
+// small one is sorted into Bottom, which is the only sorted part. Most events
+// are therefore only ever bucketed, never compared against each other.
+class LadderQueue {
+public:
+    void push(const SimEvent& e) {
+        count++;
+        if (e.time >= topStart) {
+            if (top.empty() || e.time < topMin) topMin = e.time;
+            if (top.empty() || e.time > topMax) topMax = e.time;
+            top.push_back(e);
+            return;
+        }
+        for (auto &r : rungs) {
+            if (e.time >= r.start + (long long)r.current * r.width) {
+                r.buckets[(e.time - r.start) / r.width].push_back(e);
+                return;
+            }
+        }
+        auto pos = upper_bound(bottom.begin(), bottom.end(), e, [](const SimEvent& x, const SimEvent& y){
+            return y < x;
+        });
+        bottom.insert(pos, e);
+    }
+
+    SimEvent pop() {
+        if (bottom.empty()) refill();
+        SimEvent e = bottom.back();
+        bottom.pop_back();
+        count--;
+        return e;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    static const size_t THRESHOLD = 50;
+    static const size_t MAX_RUNGS = 8;
+
+    struct Rung {
+        long long start, width;
+        size_t current;   // First bucket not yet handed down
+        vector<vector<SimEvent>> buckets;
+    };
+
+    vector<SimEvent> top;
+    long long topMin = 0, topMax = 0, topStart = LLONG_MIN;
+    vector<Rung> rungs;               // rungs.back() is the finest
+    vector<SimEvent> bottom;          // Sorted latest first
+    size_t count = 0;
+
+    // Spreads events over a new rung covering [start, start + span)
+    void spawn(vector<SimEvent> &events, long long start, long long span) {
+        Rung r;
+        r.start = start;
+        r.width = max(1LL, (span + (long long)events.size() - 1) / (long long)events.size());
+        r.current = 0;
+        r.buckets.resize((span + r.width - 1) / r.width);
+        for (const auto &e : events) r.buckets[(e.time - start) / r.width].push_back(e);
+        events.clear();
+        rungs.push_back(move(r));
+    }
+
+    void refill() {
+        while (true) {
+            if (rungs.empty()) {
+                // Start a ladder from Top; later events go back to Top
+                long long span = topMax - topMin + 1;
+                topStart = topMax + 1;
+                spawn(top, topMin, span);
+            }
+            Rung &r = rungs.back();
+            while (r.current < r.buckets.size() && r.buckets[r.current].empty()) r.current++;
+            if (r.current == r.buckets.size()) {
+                rungs.pop_back();
+                if (rungs.empty() && top.empty()) return;
+                continue;
+            }
+            vector<SimEvent> &b = r.buckets[r.current];
+            long long bucketStart = r.start + (long long)r.current * r.width;
+            r.current++;
+            if (b.size() > THRESHOLD && r.width > 1 && rungs.size() < MAX_RUNGS) {
+                vector<SimEvent> events = move(b);
+                b.clear();
+                spawn(events, bucketStart, r.width);
+                continue;
+            }
+            bottom.swap(b);
+            b.clear();
+            sort(bottom.begin(), bottom.end(), [](const SimEvent& x, const SimEvent& y){
+                return y < x;
+            });
+            return;
+        }
+    }
+};
+
+// Hold-model benchmark of one backend: either the workload itself (one pending
+// arrival at a time; each arrival schedules its completion AT + BT later), or
+// a queue kept at the workload size, where every pop pushes the event back
+// one burst later. Returns ns per push/pop pair; `hash` fingerprints the pop
+// order so the backends can be checked against each other.
+struct QueueBenchResult {
+    double workloadNs, holdNs;
+    size_t peak;
+    unsigned long long hash;
+};
+
+template <class Queue>
+QueueBenchResult benchEventQueue(const vector<Process>& byArrival, long long holds) {
+    QueueBenchResult r = {0, 0, 0, 1469598103934665603ULL};
+    auto mix = [&](const SimEvent& e) {
+        r.hash = (r.hash ^ (e.seq + 1)) * 1099511628211ULL;
+    };
+    int n = byArrival.size();
+
+    {
+        Queue q;
+        unsigned long long seq = 0;
+        long long pops = 0;
+        auto started = chrono::steady_clock::now();
+        q.push({byArrival[0].at, seq++, 0, EV_ARRIVAL});
+        while (!q.empty()) {
+            r.peak = max(r.peak, q.size());
+            SimEvent e = q.pop();
+            pops++;
+            mix(e);
+            if (e.type != EV_ARRIVAL) continue;
+            const Process &p = byArrival[e.pid];
+            q.push({e.time + p.bt, seq++, e.pid, EV_COMPLETE});
+            if (e.pid + 1 < n) q.push({byArrival[e.pid + 1].at, seq++, e.pid + 1, EV_ARRIVAL});
+        }
+        r.workloadNs = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count() / pops;
+    }
+
+    {
+        Queue q;
+        unsigned long long seq = 0;
+        for (int i = 0; i < n; i++) q.push({byArrival[i].at, seq++, i, EV_ARRIVAL});
+        auto started = chrono::steady_clock::now();
+        for (long long h = 0; h < holds; h++) {
+            SimEvent e = q.pop();
+            mix(e);
+            e.time += byArrival[h % n].bt;
+            e.seq = seq++;
+            q.push(e);
+        }
+        r.holdNs = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count() / holds;
+    }
+    return r;
+}
+
+typedef QueueBenchResult (*QueueBench)(const vector<Process>&, long long);
+
+const vector<pair<string, QueueBench>> eventQueueBackends = {
+    {"binary", benchEventQueue<DaryHeap<2>>},
+    {"4-ary", benchEventQueue<DaryHeap<4>>},
+    {"pairing", benchEventQueue<PairingHeap>},
+    {"calendar", benchEventQueue<CalendarQueue>},
+    {"ladder", benchEventQueue<LadderQueue>},
+};
+
+int benchQueueCommand(const string& path, const string& names, long long holds) {
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+    stable_sort(procs.begin(), procs.end(), [](const Process &a, const Process &b){
+        return a.at < b.at;
+    });
+    if (holds <= 0) holds = max<long long>(procs.size(), 1000000);
+
+    vector<pair<string, QueueBench>> chosen;
+    stringstream list(names);
+    string item;
+    while (getline(list, item, ',')) {
+        auto it = find_if(eventQueueBackends.begin(), eventQueueBackends.end(),
+                          [&](const pair<string, QueueBench>& b){ return b.first == item; });
+        if (it == eventQueueBackends.end()) {
+            cout << "Unknown event queue: " << item << "\n";
+            return 1;
+        }
+        chosen.push_back(*it);
+    }
+    if (names.empty()) chosen = eventQueueBackends;
+
+    cout << procs.size() << " arrivals, " << holds << " holds at size " << procs.size() << "\n\n";
+    cout << "QUEUE\t\tWORKLOAD ns/op\tHOLD ns/op\tPEAK\n";
+    cout << fixed << setprecision(1);
+    unsigned long long expected = 0;
+    bool mismatch = false;
+    for (size_t i = 0; i < chosen.size(); i++) {
+        QueueBenchResult r = chosen[i].second(procs, holds);
+        if (i == 0) expected = r.hash;
+        bool same = r.hash == expected;
+        mismatch |= !same;
+        cout << left << setw(16) << chosen[i].first << r.workloadNs << "\t\t" << r.holdNs
+             << "\t\t" << r.peak << (same ? "" : "\tORDER MISMATCH") << "\n";
+    }
+    return mismatch ? 1 : 0;
+}
+
+// Hierarchical timing wheel (Varghese and Lauck) for quantum expiry, boosts and
+// period releases. LEVELS wheels of 64 slots; a timer sits on the level of the
+// highest 6-bit digit in which its expiry differs from `now`, so level 0 holds
+// exact expiry times and each level above covers 64 times the span. Slots are
+// intrusive doubly linked lists, making arm and cancel O(1); a 64-bit mask per
+// level finds the next busy slot with one ctz. When `now` enters a higher-level
+// slot its timers cascade down, in order, so equal expiries fire in arm order.
+class TimingWheel {
+public:
+    typedef int Handle;
+
+    TimingWheel() {
+        fill(begin(heads), end(heads), -1);
+        fill(begin(tails), end(tails), -1);
+        fill(begin(occupied), end(occupied), 0);
+    }
+
+    // Expiries before the wheel's current time fire at the current time
+    Handle arm(long long time, int pid, int type = EV_PREEMPT) {
+        int id;
+        if (!freeNodes.empty()) {
+            id = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            id = nodes.size();
+            nodes.emplace_back();
+        }
+        nodes[id].e = {max(time, now), seq++, pid, type};
+        place(id);
+        count++;
+        return id;
+    }
+
+    // h must belong to a pending timer
+    void cancel(Handle h) {
+        unlink(h);
+        freeNodes.push_back(h);
+        count--;
+    }
+
+    // Advances to the earliest pending timer and removes it
+    bool pop(SimEvent &e) {
+        if (count == 0) return false;
+        int slot = nextSlot();
+        int id = heads[slot];
+        e = nodes[id].e;
+        cancel(id);
+        return true;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    static const int BITS = 6;
+    static const int SLOTS = 1 << BITS;
+    static const int LEVELS = 11;   // 66 bits: any expiry fits, no overflow list
+
+    struct Node {
+        SimEvent e;
+        int prev, next, slot;
+    };
+    vector<Node> nodes;
+    vector<int> freeNodes;
+    int heads[LEVELS * SLOTS], tails[LEVELS * SLOTS];
+    unsigned long long occupied[LEVELS];
+    long long now = 0;
+    unsigned long long seq = 0;
+    size_t count = 0;
+
+    void place(int id) {
+        long long t = nodes[id].e.time;
+        unsigned long long diff = (unsigned long long)(t ^ now);
+        int level = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / BITS;
+        int s = (t >> (level * BITS)) & (SLOTS - 1);
+        occupied[level] |= 1ULL << s;
+        int slot = level * SLOTS + s;
+        Node &n = nodes[id];
+        n.slot = slot;
+        n.prev = tails[slot];
+        n.next = -1;
+        if (tails[slot] >= 0) nodes[tails[slot]].next = id;
+        else heads[slot] = id;
+        tails[slot] = id;
+    }
+
+    void unlink(int id) {
+        Node &n = nodes[id];
+        if (n.prev >= 0) nodes[n.prev].next = n.next;
+        else heads[n.slot] = n.next;
+        if (n.next >= 0) nodes[n.next].prev = n.prev;
+        else tails[n.slot] = n.prev;
+        if (heads[n.slot] < 0) occupied[n.slot / SLOTS] &= ~(1ULL << (n.slot % SLOTS));
+    }
+
+    // Re-files every timer of a slot against the new `now`, keeping their order
+    void cascade(int slot) {
+        int id = heads[slot];
+        heads[slot] = tails[slot] = -1;
+        occupied[slot / SLOTS] &= ~(1ULL << (slot % SLOTS));
+        while (id >= 0) {
+            int next = nodes[id].next;
+            place(id);
+            id = next;
+        }
+    }
+
+    // Moves `now` to the earliest pending expiry; returns its level-0 slot
+    int nextSlot() {
+        int level = 0;
+        while (true) {
+            int shift = level * BITS;
+            int cur = (now >> shift) & (SLOTS - 1);
+            // Level 0 may hold timers due right now; above it the current
+            // slot is always empty, since its timers were cascaded on entry
+            unsigned long long from = level == 0 ? cur : cur + 1;
+            unsigned long long mask = from < SLOTS ? occupied[level] & (~0ULL << from) : 0;
+            if (!mask) {
+                level++;
+                continue;
+            }
+            int s = __builtin_ctzll(mask);
+            if (level == 0) {
+                now = (now & ~(long long)(SLOTS - 1)) | s;
+                return s;
+            }
+            now = (now >> (shift + BITS) << (shift + BITS)) | ((long long)s << shift);
+            cascade(level * SLOTS + s);
+            level = 0;
+        }
+    }
+};
+
+// Heap-based timers for comparison: cancel only marks the timer, and pop skips
+// marked entries when they surface (the usual lazy deletion).
+template <class Queue>
+class HeapTimers {
+public:
+    typedef unsigned long long Handle;
+
+    Handle arm(long long time, int pid, int type = EV_PREEMPT) {
+        q.push({time, seq, pid, type});
+        cancelled.push_back(0);
+        count++;
+        return seq++;
+    }
+
+    void cancel(Handle h) {
+        cancelled[h] = 1;
+        count--;
+    }
+
+    bool pop(SimEvent &e) {
+        while (!q.empty()) {
+            e = q.pop();
+            if (cancelled[e.seq]) continue;
+            cancelled[e.seq] = 1;
+            count--;
+            return true;
+        }
+        return false;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    Queue q;
+    vector<char> cancelled;
+    unsigned long long seq = 0;
+    size_t count = 0;
+};
+
+// Keeps `timers` timers armed the way RR / periodic tasks do: the earliest one
+// fires and its owner re-arms 1..maxDelay later, and half the time another
+// owner finishes its slice early, cancelling its timer and arming a new one.
+// The random stream is seeded, so every backend sees the same operations and
+// must fire the same sequence. Returns ns per arm / cancel / fire.
+struct TimerBenchResult {
+    double ns;
+    unsigned long long hash;
+};
+
+template <class Timers>
+TimerBenchResult benchTimers(int timers, long long rounds, long long maxDelay) {
+    TimerBenchResult r = {0, 1469598103934665603ULL};
+    mt19937_64 rng(42);
+    Timers wheel;
+    vector<typename Timers::Handle> handles(timers);
+    for (int k = 0; k < timers; k++) handles[k] = wheel.arm(1 + rng() % maxDelay, k);
+
+    long long ops = 0;
+    auto started = chrono::steady_clock::now();
+    SimEvent e;
+    for (long long i = 0; i < rounds && wheel.pop(e); i++) {
+        r.hash = (r.hash ^ (e.seq + 1)) * 1099511628211ULL;
+        handles[e.pid] = wheel.arm(e.time + 1 + rng() % maxDelay, e.pid);
+        ops += 2;
+        if (rng() & 1) {
+            int k = rng() % timers;
+            wheel.cancel(handles[k]);
+            handles[k] = wheel.arm(e.time + 1 + rng() % maxDelay, k);
+            ops += 2;
+        }
+    }
+    r.ns = chrono::duration<double, nano>(chrono::steady_clock::now() - started).count() / max(1LL, ops);
+    return r;
+}
+
+typedef TimerBenchResult (*TimerBench)(int, long long, long long);
+
+int benchTimersCommand(int timers, long long maxDelay) {
+    if (timers <= 0 || maxDelay <= 0) {
+        cout << "Timer count and delay must be positive.\n";
+        return 1;
+    }
+    const vector<pair<string, TimerBench>> backends = {
+        {"wheel", benchTimers<TimingWheel>},
+        {"binary", benchTimers<HeapTimers<DaryHeap<2>>>},
+        {"4-ary", benchTimers<HeapTimers<DaryHeap<4>>>},
+        {"pairing", benchTimers<HeapTimers<PairingHeap>>},
+    };
+    long long rounds = max(1000000LL, 4LL * timers);
+    long long far = maxDelay * 1000;
+    cout << timers << " timers, " << rounds << " expiries; delays up to " << maxDelay
+         << " (near) and " << far << " (far)\n\n";
+    cout << "TIMERS\t\tNEAR ns/op\tFAR ns/op\n";
+    cout << fixed << setprecision(1);
+    unsigned long long nearHash = 0, farHash = 0;
+    bool mismatch = false;
+    for (size_t i = 0; i < backends.size(); i++) {
+        TimerBenchResult nearRun = backends[i].second(timers, rounds, maxDelay);
+        TimerBenchResult farRun = backends[i].second(timers, rounds, far);
+        if (i == 0) {
+            nearHash = nearRun.hash;
+            farHash = farRun.hash;
+        }
+        bool same = nearRun.hash == nearHash && farRun.hash == farHash;
+        mismatch |= !same;
+        cout << left << setw(16) << backends[i].first << nearRun.ns << "\t\t" << farRun.ns
+             << (same ? "" : "\tORDER MISMATCH") << "\n";
+    }
+    return mismatch ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Ready Set Benchmark
+// -----------------------------------------------------------------------------
+
+// Times SRTF on each ready set and checks that they produce the same schedule
+int benchReadyCommand(const string& path, const string& names) {
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+    typedef Schedule (*Engine)(SimState&, SimObserver*, Checkpointer*, BurstPredictor*);
+    const vector<pair<string, Engine>> structures = {
+        {"scan", simulateSRTFWith<ScanReady>},
+        {"heap", simulateSRTFWith<HeapReady>},
+        {"segtree", simulateSRTFWith<SegmentTreeReady>},
+    };
+    vector<pair<string, Engine>> chosen;
+    stringstream list(names.empty() ? "scan,heap,segtree" : names);
+    string item;
+    while (getline(list, item, ',')) {
+        auto it = find_if(structures.begin(), structures.end(),
+                          [&](const pair<string, Engine>& s){ return s.first == item; });
+        if (it == structures.end()) {
+            cout << "Unknown ready structure: " << item << "\n";
+            return 1;
+        }
+        chosen.push_back(*it);
+    }
+
+    cout << "SRTF on " << procs.size() << " processes\n\n";
+    cout << "READY\t\tms\t\tSEGMENTS\n";
+    cout << fixed << setprecision(1);
+    vector<int> reference;
+    bool mismatch = false;
+    for (size_t k = 0; k < chosen.size(); k++) {
+        SimState st("srtf", procs);
+        auto started = chrono::steady_clock::now();
+        Schedule s = chosen[k].second(st, nullptr, nullptr, nullptr);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+        vector<int> ct(s.procs.size() + 1);
+        for (const auto &p : s.procs) ct[p.pid] = p.ct;
+        ct[0] = s.gantt.size();
+        if (k == 0) reference = ct;
+        bool same = ct == reference;
+        mismatch |= !same;
+        cout << left << setw(16) << chosen[k].first << ms << "\t\t" << s.gantt.size()
+             << (same ? "" : "\tSCHEDULE MISMATCH") << "\n";
+    }
+    return mismatch ? 1 : 0;
+}
+
+// -----------------------------------------------------------------------------
+// Approximate SJF Gap
+// -----------------------------------------------------------------------------
+
+// Runs exact SJF and asjf at each precision, and prints how far the
+// approximation's average WT / TAT lands from the exact schedule, with the
+// time each took
+int sjfGapCommand(const string& path, const string& precisions) {
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+    vector<int> levels;
+    stringstream list(precisions.empty() ? "1,2,4,8,16,64" : precisions);
+    string item;
+    while (getline(list, item, ',')) {
+        int k = atoi(item.c_str());
+        if (k <= 0 || k > BurstBuckets::MAX_PRECISION) {
+            cout << "Precision must be 1-" << BurstBuckets::MAX_PRECISION << ": " << item << "\n";
+            return 1;
+        }
+        levels.push_back(k);
+    }
+
+    auto averages = [](const Schedule& s, double &wt, double &tat) {
+        wt = tat = 0;
+        for (const auto &p : s.procs) {
+            wt += p.wt;
+            tat += p.tat;
+        }
+        wt /= s.procs.size();
+        tat /= s.procs.size();
+    };
+
+    auto started = chrono::steady_clock::now();
+    Schedule exact = runSJF(procs);
+    double exactMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    double exactWT, exactTAT;
+    averages(exact, exactWT, exactTAT);
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(12) << "VARIANT" << setw(14) << "AvgWT" << setw(14) << "AvgTAT"
+         << setw(12) << "WT gap" << setw(12) << "TAT gap" << "ms\n";
+    cout << setw(12) << "sjf" << setw(14) << exactWT << setw(14) << exactTAT
+         << setw(12) << "-" << setw(12) << "-" << exactMs << "\n";
+    for (int k : levels) {
+        started = chrono::steady_clock::now();
+        Schedule s = runApproxSJF(procs, k);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+        double wt, tat;
+        averages(s, wt, tat);
+        auto gap = [](double v, double ref) {
+            ostringstream o;
+            o << fixed << setprecision(2) << showpos << (ref > 0 ? 100 * (v - ref) / ref : 0.0) << "%";
+            return o.str();
+        };
+        cout << setw(12) << "asjf:" + to_string(k) << setw(14) << wt << setw(14) << tat
+             << setw(12) << gap(wt, exactWT) << setw(12) << gap(tat, exactTAT) << ms << "\n";
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Bulk File Writer (io_uring with pwrite fallback)
+// -----------------------------------------------------------------------------
+
+// Sequential file writer for multi-GB exports. Output is staged in a few large
+// buffers; with io_uring those buffers are registered once and written with
+// IORING_OP_WRITE_FIXED, keeping several writes in flight while the caller
+// fills the next buffer. Without io_uring (old kernel, seccomp, non-Linux) the
+// same buffers go out through plain pwrite().
+class BulkFileWriter {
+public:
+    static const int BUFFERS = 4;
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    ~BulkFileWriter() { close(); }
+
+    bool open(const string& path, bool allowUring = true) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        for (int i = 0; i < BUFFERS; i++) {
+            buffers[i] = (char*)aligned_alloc(4096, BUFFER_SIZE);
+            inFlight[i] = false;
+            if (!buffers[i]) {
+                ::close(fd);
+                fd = -1;
+                freeBuffers();
+                return false;
+            }
+        }
+        current = 0;
+        used = 0;
+        offset = 0;
+        failed = false;
+        uring = allowUring && setupUring();
+        return true;
+    }
+
+    bool usingUring() const { return uring; }
+    unsigned long long bytesWritten() const { return offset + used; }
+
+    void write(const char* data, size_t len) {
+        while (len > 0) {
+            size_t n = min(len, BUFFER_SIZE - used);
+            memcpy(buffers[current] + used, data, n);
+            used += n;
+            data += n;
+            len -= n;
+            if (used == BUFFER_SIZE) flushBuffer();
+        }
+    }
+
+    // Flushes, waits for outstanding writes and closes; false on any I/O error
+    bool close() {
+        if (fd < 0) return !failed;
+        if (used > 0) flushBuffer();
+        if (uring) {
+            while (pending > 0) reapOne();
+            teardownUring();
+        }
+        ::close(fd);
+        fd = -1;
+        freeBuffers();
+        return !failed;
+    }
+
+private:
+    int fd = -1;
+    char* buffers[BUFFERS] = {};
+    bool inFlight[BUFFERS] = {};
+    int current = 0;
+    size_t used = 0;
+    unsigned long long offset = 0;   // File offset of the current buffer
+    bool failed = false;
+    bool uring = false;
+    int pending = 0;
+
+    void freeBuffers() {
+        for (int i = 0; i < BUFFERS; i++) {
+            free(buffers[i]);
+            buffers[i] = nullptr;
+        }
+    }
+
+    // After the first error the export is lost, so later buffers are dropped
+    void flushBuffer() {
+        if (failed) {
+            // Nothing more to write
+        } else if (uring) {
+            submitWrite(current, used, offset);
+        } else if (!writeFully(buffers[current], used, offset)) {
+            failed = true;
+        }
+        offset += used;
+        used = 0;
+        current = (current + 1) % BUFFERS;
+        // Reuse the next buffer only after its previous write has completed
+        while (uring && inFlight[current]) reapOne();
+    }
+
+    bool writeFully(const char* data, size_t len, unsigned long long off) {
+        while (len > 0) {
+            ssize_t n = pwrite(fd, data, len, off);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            data += n;
+            len -= n;
+            off += n;
+        }
+        return true;
+    }
+
+#ifdef HAVE_IO_URING
+    int ringFd = -1;
+    void* sqMap = nullptr;
+    void* cqMap = nullptr;
+    size_t sqMapSize = 0, cqMapSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe* cqes;
+    size_t lengths[BUFFERS];
+    unsigned long long offsets[BUFFERS];
+
+    bool setupUring() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = syscall(__NR_io_uring_setup, BUFFERS, &params);
+        if (ringFd < 0) return false;
+
+        sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqMapSize = cqMapSize = max(sqMapSize, cqMapSize);
+
+        sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqMap == MAP_FAILED) return failSetup();
+        cqMap = single ? sqMap : mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqMap == MAP_FAILED) return failSetup();
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = (io_uring_sqe*)mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return failSetup();
+
+        char* sq = (char*)sqMap;
+        char* cq = (char*)cqMap;
+        sqHead = (unsigned*)(sq + params.sq_off.head);
+        sqTail = (unsigned*)(sq + params.sq_off.tail);
+        sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+        sqArray = (unsigned*)(sq + params.sq_off.array);
+        cqHead = (unsigned*)(cq + params.cq_off.head);
+        cqTail = (unsigned*)(cq + params.cq_off.tail);
+        cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+        cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+        iovec iov[BUFFERS];
+        for (int i = 0; i < BUFFERS; i++) iov[i] = {buffers[i], BUFFER_SIZE};
+        if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, iov, BUFFERS) < 0) return failSetup();
+        return true;
+    }
+
+    bool failSetup() {
+        teardownUring();
+        return false;
+    }
+
+    void teardownUring() {
+        if (sqes && sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqMap && cqMap != MAP_FAILED && cqMap != sqMap) munmap(cqMap, cqMapSize);
+        if (sqMap && sqMap != MAP_FAILED) munmap(sqMap, sqMapSize);
+        if (ringFd >= 0) ::close(ringFd);
+        sqes = nullptr;
+        sqMap = cqMap = nullptr;
+        ringFd = -1;
+    }
+
+    void submitWrite(int buf, size_t len, unsigned long long off) {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & *sqMask;
+        io_uring_sqe &sqe = sqes[idx];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITE_FIXED;
+        sqe.fd = fd;
+        sqe.addr = (unsigned long long)buffers[buf];
+        sqe.len = len;
+        sqe.off = off;
+        sqe.buf_index = buf;
+        sqe.user_data = buf;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        lengths[buf] = len;
+        offsets[buf] = off;
+        inFlight[buf] = true;
+        pending++;
+        if (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0) < 0) {
+            // Could not submit: complete this buffer synchronously instead
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+            if (!writeFully(buffers[buf], len, off)) failed = true;
+            inFlight[buf] = false;
+            pending--;
+        }
+    }
+
+    void reapOne() {
+        unsigned head = *cqHead;
+        while (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+                errno != EINTR) {
+                abortUring();
+                return;
+            }
+        }
+        io_uring_cqe &cqe = cqes[head & *cqMask];
+        int buf = (int)cqe.user_data;
+        int res = cqe.res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+
+        // Errors and short writes finish the remainder with pwrite
+        size_t done = res > 0 ? res : 0;
+        if (done < lengths[buf] && !writeFully(buffers[buf] + done, lengths[buf] - done, offsets[buf] + done)) {
+            failed = true;
+        }
+        inFlight[buf] = false;
+        pending--;
+    }
+
+    // Completions can no longer be collected, so the writes in flight are
+    // lost: the export fails and the ring is torn down
+    void abortUring() {
+        cerr << "Error: io_uring wait failed: " << strerror(errno) << "\n";
+        failed = true;
+        teardownUring();
+        uring = false;
+        pending = 0;
+        for (int i = 0; i < BUFFERS; i++) inFlight[i] = false;
+    }
+#else
+    bool setupUring() { return false; }
+    void teardownUring() {}
+    void submitWrite(int, size_t, unsigned long long) {}
+    void reapOne() {}
+#endif
+};
+
+// Streams the Gantt chart of one run to a file: CSV "start,end,pid" rows, or
+// packed int32 (start, end, pid) records for a .bin path. pid 0 is IDLE.
+int exportCommand(const string& spec, const string& path, const string& outPath, bool allowUring) {
+    string algo;
+    int quantum;
+    if (!parseAlgorithm(spec, algo, quantum)) {
+        cout << "Unknown algorithm: " << spec << "\n";
+        return 1;
+    }
+    vector<Process> procs;
+    if (!loadWorkload(path, procs)) return 1;
+    if (procs.empty()) {
+        cout << "Workload is empty.\n";
+        return 1;
+    }
+
+    Schedule s = runAlgorithm(algo, procs, quantum);
+
+    BulkFileWriter writer;
+    if (!writer.open(outPath, allowUring)) {
+        cout << "Cannot write schedule to " << outPath << "\n";
+        return 1;
+    }
+    bool binary = outPath.size() > 4 && outPath.compare(outPath.size() - 4, 4, ".bin") == 0;
+
+    auto started = chrono::steady_clock::now();
+    if (!binary) {
+        const char header[] = "start,end,pid\n";
+        writer.write(header, sizeof(header) - 1);
+    }
+    char line[48];
+    GanttChart::Cursor c = s.gantt.at(0);
+    GanttChart::Segment seg;
+    while (c.next(seg)) {
+        if (binary) {
+            int rec[3] = {seg.start, seg.end, seg.pid};
+            writer.write((const char*)rec, sizeof(rec));
+        } else {
+            int len = snprintf(line, sizeof(line), "%d,%d,%d\n", seg.start, seg.end, seg.pid);
+            writer.write(line, len);
+        }
+    }
+    bool usedUring = writer.usingUring();
+    unsigned long long bytes = writer.bytesWritten();
+    bool ok = writer.close();
+    if (c.failed()) {
+        cout << "Export of " << outPath << " is incomplete: the Gantt chart could not be read back\n";
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    if (!ok) {
+        cout << "I/O error while writing " << outPath << "\n";
+        return 1;
+    }
+    cout << fixed << setprecision(2);
+    cout << "Exported " << s.gantt.size() << " segments (" << bytes / 1048576.0 << " MiB) in "
+         << secs * 1000 << " ms via " << (usedUring ? "io_uring" : "pwrite") << " ("
+         << (secs > 0 ? bytes / 1048576.0 / secs : 0) << " MiB/s)\n";
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Schedule Diff
+// -----------------------------------------------------------------------------
+
+// Streams the segments of a schedule written by exportCommand: 12-byte
+// (start, end, pid) records for .bin files, "start,end,pid" lines otherwise
+class SegmentReader {
+public:
+    ~SegmentReader() {
+        if (file) fclose(file);
+    }
+
+    bool open(const string& p) {
+        path = p;
+        file = fopen(p.c_str(), "rb");
+        if (!file) return false;
+        binary = p.size() > 4 && p.compare(p.size() - 4, 4, ".bin") == 0;
+        // Every process runs at least once, so pids are bounded by the number
+        // of records the file can hold ("0,1,1\n" is the shortest CSV row)
+        struct stat info;
+        if (fstat(fileno(file), &info) == 0) maxPid = info.st_size / (binary ? sizeof(int) * 3 : 6);
+        buf.resize(1 << 20);
+        if (!binary && peek() == 's') {
+            while (get() != '\n' && !eof) {} // Header
+        }
+        return true;
+    }
+
+    // Reads the next segment; false at the end or on a malformed record
+    bool next(int &start, int &end, int &pid) {
+        if (binary) {
+            int rec[3];
+            if (!read((char*)rec, sizeof(rec))) return false;
+            start = rec[0];
+            end = rec[1];
+            pid = rec[2];
+        } else {
+            if (peek() == EOF) return false;
+            if (!number(start, ',') || !number(end, ',') || !number(pid, '\n')) {
+                bad = true;
+                return false;
+            }
+        }
+        if (end < start || (count > 0 && start != lastEnd) || pid < 0 || pid > maxPid) {
+            bad = true;
+            return false;
+        }
+        lastEnd = end;
+        count++;
+        return true;
+    }
+
+    string path;
+    bool bad = false;
+    long long count = 0;   // Segments read so far
+    int lastEnd = 0;
+
+private:
+    FILE* file = nullptr;
+    bool binary = false;
+    bool eof = false;
+    long long maxPid = LLONG_MAX;
+    vector<char> buf;
+    size_t pos = 0, len = 0;
+
+    bool fill() {
+        if (pos < len) return true;
+        len = eof ? 0 : fread(buf.data(), 1, buf.size(), file);
+        pos = 0;
+        eof = len == 0;
+        return !eof;
+    }
+    int peek() { return fill() ? (unsigned char)buf[pos] : EOF; }
+    int get() { return fill() ? (unsigned char)buf[pos++] : EOF; }
+
+    bool read(char* dst, size_t n) {
+        while (n > 0) {
+            if (!fill()) {
+                bad = bad || n != sizeof(int) * 3; // Torn record
+                return false;
+            }
+            size_t k = min(n, len - pos);
+            memcpy(dst, buf.data() + pos, k);
+            pos += k;
+            dst += k;
+            n -= k;
+        }
+        return true;
+    }
+
+    bool number(int &v, char sep) {
+        long long x = 0;
+        int c = get(), digits = 0;
+        for (; c >= '0' && c <= '9'; c = get(), digits++) {
+            x = x * 10 + (c - '0');
+            if (x > INT_MAX) return false;
+        }
+        if (c == '\r') c = get();
+        v = x;
+        return digits > 0 && (c == sep || (sep == '\n' && c == EOF));
+    }
+};
+
+// Per-process completion and first dispatch seen in one schedule
+struct ProcessTrace {
+    int first = -1;
+    int ct = -1;
+};
+
+void recordSegment(vector<ProcessTrace> &traces, int start, int end, int pid) {
+    if (pid == 0) return;
+    if ((size_t)pid >= traces.size()) traces.resize(max((size_t)pid + 1, traces.size() * 2));
+    if (traces[pid].first < 0) traces[pid].first = start;
+    traces[pid].ct = end;
+}
+
+void printDeltaRow(const string& label, vector<int> &deltas, const vector<int> &pids) {
+    if (deltas.empty()) return;
+    long long sum = 0;
+    size_t lo = 0, hi = 0;
+    for (size_t i = 0; i < deltas.size(); i++) {
+        sum += deltas[i];
+        if (deltas[i] < deltas[lo]) lo = i;
+        if (deltas[i] > deltas[hi]) hi = i;
+    }
+    int minV = deltas[lo], maxV = deltas[hi], minPid = pids[lo], maxPid = pids[hi];
+    cout << label << "\t" << (double)sum / deltas.size() << "\t" << minV << " (P" << minPid << ")\t"
+         << percentile(deltas, 0.01) << "\t" << percentile(deltas, 0.10) << "\t"
+         << percentile(deltas, 0.50) << "\t" << percentile(deltas, 0.90) << "\t"
+         << percentile(deltas, 0.99) << "\t" << maxV << " (P" << maxPid << ")\n";
+}
+
+// Compares two exported schedules in one pass over both segment streams.
+// Only the per-process tables are held in memory; TAT and WT deltas equal
+// the completion time delta, so the workload itself is not needed.
+int diffCommand(const string& pathA, const string& pathB) {
+    SegmentReader a, b;
+    for (SegmentReader* r : {&a, &b}) {
+        const string &path = r == &a ? pathA : pathB;
+        if (!r->open(path)) {
+            cout << "Cannot read " << path << "\n";
+            return 1;
+        }
+    }
+
+    vector<ProcessTrace> tracesA, tracesB;
+    int sa, ea, pa, sb, eb, pb;
+    bool hasA = a.next(sa, ea, pa), hasB = b.next(sb, eb, pb);
+    if (hasA) recordSegment(tracesA, sa, ea, pa);
+    if (hasB) recordSegment(tracesB, sb, eb, pb);
+    int divergence = -1, divA = 0, divB = 0;
+    long long differing = 0;
+
+    // Merge the two streams by time; each step covers the overlap of the
+    // current segments and then advances whichever ends first
+    while (hasA || hasB) {
+        int from = hasA && hasB ? max(sa, sb) : hasA ? sa : sb;
+        int to = hasA && hasB ? min(ea, eb) : hasA ? ea : eb;
+        bool same = hasA && hasB && pa == pb;
+        if (!same && to > from) {
+            differing += to - from;
+            if (divergence < 0) {
+                divergence = from;
+                divA = hasA ? pa : -1;
+                divB = hasB ? pb : -1;
+            }
+        }
+        bool advanceA = hasA && (!hasB || ea <= eb);
+        bool advanceB = hasB && (!hasA || eb <= ea);
+        if (advanceA && (hasA = a.next(sa, ea, pa))) recordSegment(tracesA, sa, ea, pa);
+        if (advanceB && (hasB = b.next(sb, eb, pb))) recordSegment(tracesB, sb, eb, pb);
+    }
+    for (SegmentReader* r : {&a, &b}) {
+        if (r->bad) {
+            cout << "Malformed segment " << r->count + 1 << " in " << r->path << "\n";
+            return 1;
+        }
+    }
+
+    // Per-process deltas (B - A), merged by pid
+    vector<int> pids, ctDelta, rtDelta;
+    long long onlyA = 0, onlyB = 0, faster = 0, slower = 0;
+    for (size_t pid = 1; pid < max(tracesA.size(), tracesB.size()); pid++) {
+        bool inA = pid < tracesA.size() && tracesA[pid].ct >= 0;
+        bool inB = pid < tracesB.size() && tracesB[pid].ct >= 0;
+        onlyA += inA && !inB;
+        onlyB += inB && !inA;
+        if (!inA || !inB) continue;
+        int d = tracesB[pid].ct - tracesA[pid].ct;
+        pids.push_back(pid);
+        ctDelta.push_back(d);
+        rtDelta.push_back(tracesB[pid].first - tracesA[pid].first);
+        faster += d < 0;
+        slower += d > 0;
+    }
+
+    int makespan = max(a.lastEnd, b.lastEnd);
+    cout << fixed << setprecision(2);
+    cout << "A: " << pathA << " (" << a.count << " segments, makespan " << a.lastEnd << ")\n";
+    cout << "B: " << pathB << " (" << b.count << " segments, makespan " << b.lastEnd << ")\n";
+    if (divergence < 0) {
+        cout << "Schedules are identical.\n";
+    } else {
+        auto label = [](int pid) { return pid < 0 ? string("(ended)") : segmentLabel(pid); };
+        cout << "First divergence at t=" << divergence << ": A runs " << label(divA)
+             << ", B runs " << label(divB) << "\n";
+        cout << "Time assigned differently: " << differing << " units ("
+             << (makespan > 0 ? 100.0 * differing / makespan : 0) << "% of " << makespan << ")\n";
+    }
+    cout << "\nProcesses compared: " << pids.size() << " (faster in B: " << faster << ", slower: "
+         << slower << ", unchanged: " << pids.size() - faster - slower << ")\n";
+    if (onlyA || onlyB) cout << "Only in A: " << onlyA << ", only in B: " << onlyB << "\n";
+    if (pids.empty()) return 0;
+
+    cout << "\nDelta B - A\tMEAN\tMIN\tP1\tP10\tP50\tP90\tP99\tMAX\n";
+    printDeltaRow("TAT/WT/CT", ctDelta, pids);
+    printDeltaRow("RT", rtDelta, pids);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Command Line Mode
+// -----------------------------------------------------------------------------
+
+void printUsage(const char* prog) {
+    cout << "Usage:\n";
+    cout << "  " << prog << "                                   Interactive mode\n";
+    cout << "  " << prog << " run <algorithm>[,<algorithm>...] <workload.csv> [out.txt]\n";
+    cout << "  " << prog << " run <algorithm> <workload.csv> [out.txt] --checkpoint <file> [--interval <sec>]\n";
+    cout << "  " << prog << " run --resume <file> [out.txt] [--interval <sec>]\n";
+    cout << "  " << prog << " classes <fcfs|sjf|priority|check> <workload.csv>\n";
+    cout << "  " << prog << " query <algorithm> <workload.csv> <t> [t2]\n";
+    cout << "  " << prog << " plan <algorithm> <workload.csv>         Edit jobs from stdin\n";
+    cout << "  " << prog << " whatif <algorithm> <workload.csv> <t> <algorithm>[,<algorithm>...]\n";
+    cout << "  " << prog << " record <algorithm> <workload.csv> <log.evl>\n";
+    cout << "  " << prog << " replay <log.evl>\n";
+    cout << "  " << prog << " export <algorithm> <workload.csv> <out.csv|out.bin> [--pwrite]\n";
+    cout << "  " << prog << " diff <a.csv|a.bin> <b.csv|b.bin>       Compare two exported schedules\n";
+    cout << "  " << prog << " import-trace <trace.txt> <out.csv> [ns|us|ms]\n";
+    cout << "  " << prog << " calibrate <workload.csv> <other|fifo|rr> <unit-us> [cpus] [algorithm]\n";
+    cout << "  " << prog << " fairness <algorithm> <workload.csv>   Slowdown stats, no Gantt chart\n";
+    cout << "  " << prog << " batch <algorithm> <dir|batch-file> <out.csv> [threads]\n";
+    cout << "  " << prog << " series <algorithm> <workload.csv> <window> <out.csv|out.bin>\n";
+    cout << "  " << prog << " benchq <workload.csv> [queue,...] [holds]   Benchmark event queues\n";
+    cout << "  " << prog << " benchtimers [timers] [max-delay]      Timing wheel vs heap timers\n";
+    cout << "  " << prog << " benchready <workload.csv> [ready,...]  SRTF on each ready set\n";
+    cout << "  " << prog << " sjfgap <workload.csv> [precision,...]  asjf vs exact SJF\n";
+    cout << "\nAny command accepts --gantt-mem <MiB> to cap the Gantt charts held in memory;\n";
+    cout << "beyond it they spill to a temporary file under $TMPDIR.\n";
+    cout << "--ready <scan|heap|segtree> picks the SRTF ready set (default segtree).\n";
+    cout << "--predict <ema:<alpha>[:<initial>]|last[:<initial>]|oracle> sets the psjf / psrtf\n";
+    cout << "burst predictor (default ema:0.5, initial guess 10).\n";
+    cout << "\nAlgorithms: fcfs, sjf, priority, srtf, rr:<quantum>, asjf[:<buckets per octave>],\n";
+    cout << "psjf, psrtf (SJF / SRTF on predicted bursts)\n";
+    cout << "Event queues: binary, 4-ary, pairing, calendar, ladder\n";
+    cout << "\nWorkload files hold one process per line: AT,BT[,PRI[,TASK]]. Rows sharing a\n";
+    cout << "TASK are successive CPU bursts of one task, the history psjf / psrtf predict from.\n";
+}
+
+int runCommand(int argc, char* argv[]) {
+    // --gantt-mem, --ready and --predict apply to every command; drop them before dispatching
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--gantt-mem" && i + 1 < argc) {
+            ganttMemoryCap = (size_t)(atof(argv[++i]) * 1048576);
+        } else if (string(argv[i]) == "--predict" && i + 1 < argc) {
+            predictorSpec = argv[++i];
+            if (!makePredictor(predictorSpec)) {
+                cout << "Invalid predictor: " << predictorSpec << "\n";
+                return 1;
+            }
+        } else if (string(argv[i]) == "--ready" && i + 1 < argc) {
+            readyStructure = argv[++i];
+            if (readyStructure != "scan" && readyStructure != "heap" && readyStructure != "segtree") {
+                cout << "Unknown ready structure: " << readyStructure << "\n";
+                return 1;
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    string cmd = argv[1];
+
+    if (cmd == "classes" && argc == 4) {
+        string algo = argv[2];
+        if (algo == "check") return classCheckCommand(argv[3]);
+        vector<Process> procs;
+        if (!loadWorkload(argv[3], procs)) return 1;
+        if (procs.empty()) {
+            cout << "Workload is empty.\n";
+            return 1;
+        }
+
+        vector<JobClass> classes = compressWorkload(procs, algo);
+        procs.clear();
+        procs.shrink_to_fit();
+
+        if (algo == "fcfs") FCFSClasses(classes);
+        else if (algo == "sjf") NonPreemptiveClasses(classes, false, "SJF - Non Preemptive");
+        else if (algo == "priority") NonPreemptiveClasses(classes, true, "Priority Scheduling (Non-Preemptive)");
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (cmd == "run") {
+        // Split "--name value" options from the positional arguments
+        vector<string> args;
+        string ckptPath, resumePath;
+        double interval = 60;
+        bool ok = true;
+        for (int i = 2; i < argc; i++) {
+            string a = argv[i];
+            if (a == "--checkpoint" || a == "--resume" || a == "--interval") {
+                if (i + 1 == argc) { ok = false; break; }
+                string v = argv[++i];
+                if (a == "--checkpoint") ckptPath = v;
+                else if (a == "--resume") resumePath = v;
+                else interval = atof(v.c_str());
+            } else {
+                args.push_back(a);
+            }
+        }
+        if (ok && !resumePath.empty() && args.size() <= 1) {
+            return checkpointedRunCommand("", "", resumePath, resumePath, interval,
+                                          args.empty() ? "" : args[0]);
+        }
+        if (ok && !ckptPath.empty() && resumePath.empty() && (args.size() == 2 || args.size() == 3)) {
+            return checkpointedRunCommand(args[0], args[1], "", ckptPath, interval,
+                                          args.size() == 3 ? args[2] : "");
+        }
+    }
+
+    if (cmd == "run" && (argc == 4 || argc == 5)) {
+        return runCommandAsync(argv[2], argv[3], argc == 5 ? argv[4] : "");
+    }
+
+    if (cmd == "query" && (argc == 5 || argc == 6)) {
+        int t1 = atoi(argv[4]);
+        int t2 = argc == 6 ? atoi(argv[5]) : t1;
+        return queryCommand(argv[2], argv[3], t1, t2, argc == 6);
+    }
+
+    if (cmd == "plan" && argc == 4) {
+        return planCommand(argv[2], argv[3]);
+    }
+
+    if (cmd == "whatif" && argc == 6) {
+        return whatIfCommand(argv[2], argv[3], atoi(argv[4]), argv[5]);
+    }
+
+    if (cmd == "export" && (argc == 5 || (argc == 6 && string(argv[5]) == "--pwrite"))) {
+        return exportCommand(argv[2], argv[3], argv[4], argc == 5);
+    }
+
+    if (cmd == "record" && argc == 5) {
+        return recordCommand(argv[2], argv[3], argv[4]);
+    }
+
+    if (cmd == "replay" && argc == 3) {
+        return replayCommand(argv[2]);
+    }
+
+    if (cmd == "diff" && argc == 4) {
+        return diffCommand(argv[2], argv[3]);
+    }
+
+    if (cmd == "import-trace" && (argc == 4 || argc == 5)) {
+        return importTraceCommand(argv[2], argv[3], argc == 5 ? argv[4] : "us");
+    }
+
+    if (cmd == "calibrate" && argc >= 5 && argc <= 7) {
+        return calibrateCommand(argv[2], argv[3], atof(argv[4]), argc >= 6 ? argv[5] : "0",
+                                argc == 7 ? argv[6] : "");
+    }
+
+    if (cmd == "fairness" && argc == 4) {
+        return fairnessCommand(argv[2], argv[3]);
+    }
+
+    if (cmd == "batch" && (argc == 5 || argc == 6)) {
+        return batchCommand(argv[2], argv[3], argv[4], argc == 6 ? atoi(argv[5]) : 0);
+    }
+
+    if (cmd == "series" && argc == 6) {
+        return seriesCommand(argv[2], argv[3], atoi(argv[4]), argv[5]);
+    }
+
+    if (cmd == "benchq" && argc >= 3 && argc <= 5) {
+        return benchQueueCommand(argv[2], argc >= 4 ? argv[3] : "", argc == 5 ? atoll(argv[4]) : 0);
+    }
+
+    if (cmd == "benchtimers" && argc <= 4) {
+        return benchTimersCommand(argc >= 3 ? atoi(argv[2]) : 1000000, argc == 4 ? atoll(argv[3]) : 1000);
+    }
+
+    if (cmd == "benchready" && (argc == 3 || argc == 4)) {
+        return benchReadyCommand(argv[2], argc == 4 ? argv[3] : "");
+    }
+
+    if (cmd == "sjfgap" && (argc == 3 || argc == 4)) {
+        return sjfGapCommand(argv[2], argc == 4 ? argv[3] : "");
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
+
+// -----------------------------------------------------------------------------
+// Main Driver Function
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        int status = runCommand(argc, argv);
+        return status == 0 && ganttReadFailed ? 1 : status;
+    }
+
     // Set output formatting
     cout << fixed << setprecision(2);
 